@@ -0,0 +1,172 @@
+#include "boardmetrics.h"
+#include <QtConcurrent>
+#include <QThread>
+#include <QVector>
+
+namespace {
+
+struct Band {
+    int firstRow;
+    int lastRow;
+};
+
+int findRoot(std::vector<int>& parent, int x)
+{
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+// 总是把较大的根挂到较小的根下，保证根是连通块中最靠前的格子
+void unite(std::vector<int>& parent, int a, int b)
+{
+    a = findRoot(parent, a);
+    b = findRoot(parent, b);
+    if (a == b) return;
+    if (a < b) parent[b] = a;
+    else parent[a] = b;
+}
+
+void mergeAbove(const std::vector<signed char>& numbers, int cols, std::vector<int>& parent, int i, int j)
+{
+    int pos = i * cols + j;
+    for (int y = (j > 0 ? j - 1 : 0); y <= (j < cols - 1 ? j + 1 : j); ++y) {
+        int above = (i - 1) * cols + y;
+        if (numbers[above] == 0) unite(parent, pos, above);
+    }
+}
+
+// 单遍光栅扫描：每个 0 只需与左、左上、上、右上四个已访问邻居合并。
+// 只看带内的行，因此不同的带可以并行处理
+void labelBand(const std::vector<signed char>& numbers, int cols, std::vector<int>& parent, const Band& band)
+{
+    for (int i = band.firstRow; i <= band.lastRow; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            int pos = i * cols + j;
+            parent[pos] = pos;
+            if (numbers[pos] != 0) continue;
+
+            if (j > 0 && numbers[pos - 1] == 0) unite(parent, pos, pos - 1);
+            if (i > band.firstRow) mergeAbove(numbers, cols, parent, i, j);
+        }
+    }
+}
+
+// 数字格周围不同空白区的编号，去重后写入 out，返回个数
+int adjacentOpenings(const OpeningIndex& index, int rows, int cols, int pos, int out[8])
+{
+    int row = pos / cols;
+    int col = pos % cols;
+    int found = 0;
+    for (int x = (row > 0 ? row - 1 : 0); x <= (row < rows - 1 ? row + 1 : row); ++x) {
+        for (int y = (col > 0 ? col - 1 : 0); y <= (col < cols - 1 ? col + 1 : col); ++y) {
+            int opening = index.openingOf[x * cols + y];
+            if (opening < 0) continue;
+
+            bool seen = false;
+            for (int k = 0; k < found && !seen; ++k) seen = (out[k] == opening);
+            if (!seen) out[found++] = opening;
+        }
+    }
+    return found;
+}
+
+}
+
+void computeNumbers(const std::vector<char>& mines, int rows, int cols, std::vector<signed char>& numbers)
+{
+    numbers.assign(rows * cols, 0);
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            int pos = i * cols + j;
+            if (!mines[pos]) continue;
+
+            numbers[pos] = -1;
+            for (int x = (i > 0 ? i - 1 : 0); x <= (i < rows - 1 ? i + 1 : i); ++x) {
+                for (int y = (j > 0 ? j - 1 : 0); y <= (j < cols - 1 ? j + 1 : j); ++y) {
+                    if (numbers[x * cols + y] >= 0) numbers[x * cols + y]++;
+                }
+            }
+        }
+    }
+}
+
+void buildOpeningIndex(const std::vector<signed char>& numbers, int rows, int cols, OpeningIndex& index)
+{
+    const int total = rows * cols;
+    std::vector<int> parent(total);
+
+    int bandCount = 1;
+    if (total >= ParallelLabelThreshold) {
+        bandCount = qBound(1, QThread::idealThreadCount(), rows);
+    }
+
+    QVector<Band> bands;
+    for (int b = 0; b < bandCount; ++b) {
+        Band band;
+        band.firstRow = rows * b / bandCount;
+        band.lastRow = rows * (b + 1) / bandCount - 1;
+        bands.append(band);
+    }
+
+    if (bandCount > 1) {
+        QtConcurrent::blockingMap(bands, [&](const Band& band) {
+            labelBand(numbers, cols, parent, band);
+        });
+        // 带与带之间的接缝串行合并
+        for (int b = 1; b < bandCount; ++b) {
+            int i = bands[b].firstRow;
+            for (int j = 0; j < cols; ++j) {
+                if (numbers[i * cols + j] == 0) mergeAbove(numbers, cols, parent, i, j);
+            }
+        }
+    } else if (total > 0) {
+        labelBand(numbers, cols, parent, bands[0]);
+    }
+
+    // 根是连通块里最靠前的格子，一遍扫描即可分配连续编号
+    index.openingOf.assign(total, -1);
+    int openings = 0;
+    for (int pos = 0; pos < total; ++pos) {
+        if (numbers[pos] != 0) continue;
+        int root = findRoot(parent, pos);
+        index.openingOf[pos] = (root == pos) ? openings++ : index.openingOf[root];
+    }
+
+    // 两遍 CSR：先数每个空白区的格子数，再按前缀和填充
+    index.offsets.assign(openings + 1, 0);
+    int neighbours[8];
+    for (int pos = 0; pos < total; ++pos) {
+        if (numbers[pos] == 0) {
+            index.offsets[index.openingOf[pos] + 1]++;
+        } else if (numbers[pos] > 0) {
+            int found = adjacentOpenings(index, rows, cols, pos, neighbours);
+            for (int k = 0; k < found; ++k) index.offsets[neighbours[k] + 1]++;
+        }
+    }
+    for (int k = 0; k < openings; ++k) index.offsets[k + 1] += index.offsets[k];
+
+    index.cells.resize(index.offsets[openings]);
+    std::vector<int> cursor(index.offsets.begin(), index.offsets.end() - 1);
+    for (int pos = 0; pos < total; ++pos) {
+        if (numbers[pos] == 0) {
+            index.cells[cursor[index.openingOf[pos]]++] = pos;
+        } else if (numbers[pos] > 0) {
+            int found = adjacentOpenings(index, rows, cols, pos, neighbours);
+            for (int k = 0; k < found; ++k) index.cells[cursor[neighbours[k]]++] = pos;
+        }
+    }
+}
+
+int compute3BV(const std::vector<signed char>& numbers, int rows, int cols, const OpeningIndex& index)
+{
+    const int total = rows * cols;
+    int bbbv = index.openingCount();
+    int neighbours[8];
+    for (int pos = 0; pos < total; ++pos) {
+        if (numbers[pos] > 0 && adjacentOpenings(index, rows, cols, pos, neighbours) == 0) bbbv++;
+    }
+    return bbbv;
+}
@@ -0,0 +1,30 @@
+#ifndef BOARDMETRICS_H
+#define BOARDMETRICS_H
+#include <vector>
+
+// 棋盘按行展开：numbers[row * cols + col] 为 -1 表示地雷，否则为周围地雷数
+
+// 由地雷布局（mines[pos] 非 0 为雷）计算 numbers
+void computeNumbers(const std::vector<char>& mines, int rows, int cols, std::vector<signed char>& numbers);
+
+// 空白区索引：生成棋盘时一次性标记所有 0 连通块（含其数字边界），
+// 点开任意一个 0 时直接按表展开，不再递归检查邻居
+struct OpeningIndex
+{
+    std::vector<int> openingOf;   // 0 格所属空白区编号，其他格为 -1
+    std::vector<int> offsets;     // 空白区 k 的格子为 cells[offsets[k], offsets[k + 1])
+    std::vector<int> cells;       // 按空白区连续存放的格子位置
+
+    int openingCount() const { return offsets.empty() ? 0 : int(offsets.size()) - 1; }
+};
+
+// 超过此格数时按行分带并行标记
+const int ParallelLabelThreshold = 1 << 20;
+
+void buildOpeningIndex(const std::vector<signed char>& numbers, int rows, int cols, OpeningIndex& index);
+
+// 3BV：不借助标记清空棋盘所需的最少左键次数
+// = 空白区数量 + 不与任何 0 相邻的数字格数量，O(rows*cols)
+int compute3BV(const std::vector<signed char>& numbers, int rows, int cols, const OpeningIndex& index);
+
+#endif // BOARDMETRICS_H
@@ -0,0 +1,234 @@
+#include "boardprefetcher.h"
+#include "gamesaver.h"
+#include <QtConcurrent>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+BoardPrefetcher::BoardPrefetcher(QObject *parent)
+    : QObject(parent),
+      rows(0),
+      cols(0),
+      numMines(0),
+      watcher(new QFutureWatcher<PreparedBoardPtr>(this)),
+      prepareWatcher(new QFutureWatcher<PreparedBoardPtr>(this)),
+      openingsWatcher(new QFutureWatcher<PreparedBoardPtr>(this))
+{
+    connect(watcher, SIGNAL(finished()), this, SLOT(onLayoutReady()));
+    connect(prepareWatcher, SIGNAL(finished()), this, SLOT(onBoardPrepared()));
+    connect(openingsWatcher, SIGNAL(finished()), this, SLOT(onOpeningsReady()));
+}
+
+BoardPrefetcher::~BoardPrefetcher()
+{
+    watcher->waitForFinished();
+    prepareWatcher->waitForFinished();
+    openingsWatcher->waitForFinished();
+}
+
+void BoardPrefetcher::prefetch(int rows, int cols, int numMines)
+{
+    if (rows != this->rows || cols != this->cols || numMines != this->numMines) {
+        this->rows = rows;
+        this->cols = cols;
+        this->numMines = numMines;
+        ready.clear();
+    }
+    startNext();
+}
+
+int BoardPrefetcher::poolSize() const
+{
+    return rows * cols > LargeBoardCells ? 1 : PoolSize;
+}
+
+void BoardPrefetcher::startNext()
+{
+    if (watcher->isRunning() || ready.size() >= poolSize() || rows * cols == 0) return;
+
+    int r = rows, c = cols, m = numMines;
+    quint32 seed = quint32(std::rand());
+    watcher->setFuture(QtConcurrent::run([r, c, m, seed]() {
+        PreparedBoardPtr board = build(generate(r, c, m, seed), r, c, m, seed);
+        analyzeOpenings(*board);
+        return board;
+    }));
+}
+
+void BoardPrefetcher::onLayoutReady()
+{
+    PreparedBoardPtr board = watcher->result();
+    // 生成期间难度可能已经变了，旧尺寸的布局直接丢弃
+    if (board->rows == rows && board->cols == cols && board->numMines == numMines) {
+        ready.append(board);
+    }
+    startNext();
+}
+
+PreparedBoardPtr BoardPrefetcher::take(int clickRow, int clickCol)
+{
+    if (ready.isEmpty()) {
+        startNext();
+        return PreparedBoardPtr();
+    }
+
+    PreparedBoardPtr board = ready.takeFirst();
+    if (fitToClick(*board, clickRow, clickCol)) {
+        // 数字已经就地修正；空白区可能合并或拆开，交给后台按新位图重建
+        board->openings = OpeningIndex();
+        board->openingsValid = false;
+
+        int r = rows, c = cols, m = numMines;
+        quint32 seed = board->seed;
+        QByteArray bits = board->mineBits;
+        openingsWatcher->setFuture(QtConcurrent::run([r, c, m, seed, bits]() {
+            PreparedBoardPtr result(new PreparedBoard);
+            result->rows = r;
+            result->cols = c;
+            result->numMines = m;
+            result->seed = seed;
+            analyze(GameSaver::unpackBits(bits, r * c), *result);
+            // 调用方只要空白区和 3BV
+            std::vector<signed char>().swap(result->numbers);
+            return result;
+        }));
+    }
+    startNext();
+    return board;
+}
+
+void BoardPrefetcher::onOpeningsReady()
+{
+    emit openingsReady(openingsWatcher->result());
+}
+
+PreparedBoardPtr BoardPrefetcher::waitForOpenings()
+{
+    openingsWatcher->waitForFinished();
+    return openingsWatcher->result();
+}
+
+void BoardPrefetcher::prepareFor(int clickRow, int clickCol)
+{
+    int r = rows, c = cols, m = numMines;
+    quint32 seed = quint32(std::rand());
+    prepareWatcher->setFuture(QtConcurrent::run([r, c, m, seed, clickRow, clickCol]() {
+        PreparedBoardPtr board = build(generate(r, c, m, seed), r, c, m, seed);
+        fitToClick(*board, clickRow, clickCol);
+        analyzeOpenings(*board);
+        return board;
+    }));
+}
+
+void BoardPrefetcher::onBoardPrepared()
+{
+    PreparedBoardPtr board = prepareWatcher->result();
+    if (board->rows == rows && board->cols == cols && board->numMines == numMines) {
+        emit boardPrepared(board);
+    }
+}
+
+std::vector<char> BoardPrefetcher::generate(int rows, int cols, int numMines, quint32 seed)
+{
+    std::vector<char> mines(rows * cols, 0);
+
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> cell(0, rows * cols - 1);
+    int minesPlaced = 0;
+    while (minesPlaced < numMines) {
+        int pos = cell(rng);
+        if (!mines[pos]) {
+            mines[pos] = 1;
+            minesPlaced++;
+        }
+    }
+    return mines;
+}
+
+void BoardPrefetcher::analyze(const std::vector<char>& mines, PreparedBoard& board)
+{
+    computeNumbers(mines, board.rows, board.cols, board.numbers);
+    analyzeOpenings(board);
+}
+
+void BoardPrefetcher::analyzeOpenings(PreparedBoard& board)
+{
+    buildOpeningIndex(board.numbers, board.rows, board.cols, board.openings);
+    board.bbbv = compute3BV(board.numbers, board.rows, board.cols, board.openings);
+    board.openingsValid = true;
+}
+
+PreparedBoardPtr BoardPrefetcher::build(const std::vector<char>& mines, int rows, int cols, int numMines, quint32 seed)
+{
+    PreparedBoardPtr board(new PreparedBoard);
+    board->rows = rows;
+    board->cols = cols;
+    board->numMines = numMines;
+    board->seed = seed;
+    board->clickRow = board->clickCol = -1;
+    board->bbbv = 0;
+    board->openingsValid = false;
+    computeNumbers(mines, rows, cols, board->numbers);
+    board->mineBits = GameSaver::packBits(mines);
+    return board;
+}
+
+bool BoardPrefetcher::fitToClick(PreparedBoard& board, int clickRow, int clickCol)
+{
+    const int r = board.rows, c = board.cols;
+    std::vector<signed char>& numbers = board.numbers;
+    char* bits = board.mineBits.data();
+    board.clickRow = clickRow;
+    board.clickCol = clickCol;
+
+    // 安全区只含首击格和棋盘内的邻格，与直接避开它布雷一致
+    int top = qMax(0, clickRow - 1), bottom = qMin(r - 1, clickRow + 1);
+    int left = qMax(0, clickCol - 1), right = qMin(c - 1, clickCol + 1);
+
+    std::vector<int> changed;
+    for (int x = top; x <= bottom; ++x) {
+        for (int y = left; y <= right; ++y) {
+            int pos = x * c + y;
+            if (numbers[pos] >= 0) continue;
+            numbers[pos] = 0;
+            bits[pos / 8] &= char(~(1 << (pos % 8)));
+            changed.push_back(pos);
+        }
+    }
+    if (changed.empty()) return false;
+
+    // 挪走的雷重新均匀落在安全区外的空格上：
+    // 原布局在安全区外本就均匀，补上的雷也均匀，结果与避开安全区直接布雷同分布
+    std::seed_seq sequence{board.seed, quint32(clickRow), quint32(clickCol)};
+    std::mt19937 rng(sequence);
+    std::uniform_int_distribution<int> cell(0, r * c - 1);
+    int moved = int(changed.size());
+    for (int k = 0; k < moved; ++k) {
+        int pos;
+        do {
+            pos = cell(rng);
+        } while (numbers[pos] < 0 ||
+                 (pos / c >= top && pos / c <= bottom && pos % c >= left && pos % c <= right));
+        numbers[pos] = -1;
+        bits[pos / 8] |= char(1 << (pos % 8));
+        changed.push_back(pos);
+    }
+
+    // 只重算变动格周围的数字
+    for (int pos : changed) {
+        int i = pos / c, j = pos % c;
+        for (int x = qMax(0, i - 1); x <= qMin(r - 1, i + 1); ++x) {
+            for (int y = qMax(0, j - 1); y <= qMin(c - 1, j + 1); ++y) {
+                if (numbers[x * c + y] < 0) continue;
+                int count = 0;
+                for (int a = qMax(0, x - 1); a <= qMin(r - 1, x + 1); ++a) {
+                    for (int b = qMax(0, y - 1); b <= qMin(c - 1, y + 1); ++b) {
+                        if (numbers[a * c + b] < 0) count++;
+                    }
+                }
+                numbers[x * c + y] = count;
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef BOARDPREFETCHER_H
+#define BOARDPREFETCHER_H
+#include <QObject>
+#include <QList>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <vector>
+#include "boardmetrics.h"
+
+// 可以直接开局的棋盘。地雷布局由 seed 生成，再把首击周围的雷
+// 移到别处（移雷的随机数也由 seed 和首击位置决定），两者一起即可复现
+struct PreparedBoard
+{
+    int rows;
+    int cols;
+    int numMines;
+    quint32 seed;
+    int clickRow;                       // 尚未按首击调整时为 -1
+    int clickCol;
+    std::vector<signed char> numbers;   // -1 为地雷，否则为周围地雷数
+    OpeningIndex openings;
+    int bbbv;
+    bool openingsValid;                 // 移雷后空白区和 3BV 需要重建
+    QByteArray mineBits;                // 存档用的地雷位图
+};
+typedef QSharedPointer<PreparedBoard> PreparedBoardPtr;
+
+// 在后台线程预先生成当前难度的地雷布局并算好数字、空白区和 3BV，
+// 首次点击时直接取用，不让生成和分析的耗时落在 GUI 线程上
+class BoardPrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit BoardPrefetcher(QObject *parent = nullptr);
+    ~BoardPrefetcher();
+
+    void prefetch(int rows, int cols, int numMines);
+
+    // 取出一张预生成的布局并就地把首击 3x3 里的雷挪走，只改动附近的数字。
+    // 挪过雷时空白区和 3BV 在后台重建，完成后发出 openingsReady。
+    // 池子还空着时返回空
+    PreparedBoardPtr take(int clickRow, int clickCol);
+
+    // 池子为空时在后台生成并按首击调整一张布局，完成后发出 boardPrepared
+    void prepareFor(int clickRow, int clickCol);
+
+    // 阻塞等待正在重建的空白区（还没展开完就赢了时用）
+    PreparedBoardPtr waitForOpenings();
+
+    // 由地雷布局计算数字、空白区索引和 3BV，board 的尺寸须已填好
+    static void analyze(const std::vector<char>& mines, PreparedBoard& board);
+
+    static const int PoolSize = 2;
+    // 超过此格数时只预留一张：分析好的大棋盘每格约 9 字节
+    static const int LargeBoardCells = 1 << 20;
+signals:
+    void boardPrepared(PreparedBoardPtr board);
+    void openingsReady(PreparedBoardPtr board);
+private slots:
+    void onLayoutReady();
+    void onBoardPrepared();
+    void onOpeningsReady();
+private:
+    int rows, cols, numMines;
+    QList<PreparedBoardPtr> ready;
+    QFutureWatcher<PreparedBoardPtr>* watcher;
+    QFutureWatcher<PreparedBoardPtr>* prepareWatcher;
+    QFutureWatcher<PreparedBoardPtr>* openingsWatcher;
+
+    int poolSize() const;
+    void startNext();
+    static std::vector<char> generate(int rows, int cols, int numMines, quint32 seed);
+    static PreparedBoardPtr build(const std::vector<char>& mines, int rows, int cols, int numMines, quint32 seed);
+    static void analyzeOpenings(PreparedBoard& board);
+    static bool fitToClick(PreparedBoard& board, int clickRow, int clickCol);
+};
+
+#endif // BOARDPREFETCHER_H
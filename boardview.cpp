@@ -0,0 +1,455 @@
+#include "boardview.h"
+#include <QApplication>
+#include <QDesktopWidget>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QTimer>
+#include <QWheelEvent>
+#include <cmath>
+
+namespace {
+
+const QRgb HiddenColor = qRgb(204, 204, 204);
+const QRgb RevealedColor = qRgb(238, 238, 238);
+const QRgb FlagColor = qRgb(255, 204, 204);
+const QRgb MineColor = qRgb(255, 170, 170);
+const QRgb ExplodedColor = qRgb(255, 0, 0);
+const QRgb WrongFlagColor = qRgb(255, 204, 102);
+const QRgb SafeFlagColor = qRgb(204, 255, 204);
+
+const int StateCount = BoardView::Revealed + 9;
+
+bool isRevealedState(int state) { return state >= BoardView::Revealed; }
+
+QRgb stateColor(int state)
+{
+    switch (state) {
+        case BoardView::Flagged: return FlagColor;
+        case BoardView::Mine: return MineColor;
+        case BoardView::Exploded: return ExplodedColor;
+        case BoardView::WrongFlag: return WrongFlagColor;
+        case BoardView::SafeFlag: return SafeFlagColor;
+        default: return isRevealedState(state) ? RevealedColor : HiddenColor;
+    }
+}
+
+QVector<QRgb> stateColorTable()
+{
+    QVector<QRgb> table(StateCount);
+    for (int state = 0; state < StateCount; ++state) table[state] = stateColor(state);
+    return table;
+}
+
+// 数字 1-8 的颜色，下标 0 不用
+const QRgb NumberColors[9] = {
+    qRgb(0, 0, 0),
+    qRgb(0, 0, 255),        // blue
+    qRgb(0, 128, 0),        // green
+    qRgb(255, 0, 0),        // red
+    qRgb(0, 0, 139),        // darkblue
+    qRgb(139, 0, 0),        // darkred
+    qRgb(0, 255, 255),      // cyan
+    qRgb(0, 0, 0),          // black
+    qRgb(128, 128, 128)     // gray
+};
+const QRgb TextColor = qRgb(0, 0, 0);
+const QRgb SafeFlagTextColor = qRgb(0, 128, 0);
+const QRgb HiddenBorderColor = qRgb(128, 128, 128);
+const QRgb RevealedBorderColor = qRgb(136, 136, 136);
+
+QRgb stateTextColor(int state)
+{
+    if (state == BoardView::SafeFlag) return SafeFlagTextColor;
+    if (state > BoardView::Revealed) return NumberColors[state - BoardView::Revealed];
+    return TextColor;
+}
+
+QString stateText(int state)
+{
+    switch (state) {
+        case BoardView::Flagged:
+        case BoardView::SafeFlag: return "F";
+        case BoardView::Mine:
+        case BoardView::Exploded: return "*";
+        case BoardView::WrongFlag: return "X";
+        default: return state > BoardView::Revealed ? QString::number(state - BoardView::Revealed) : QString();
+    }
+}
+
+}
+
+BoardView::BoardView(QWidget *parent)
+    : QAbstractScrollArea(parent),
+      rows(0),
+      cols(0),
+      cellSize(DefaultCellSize),
+      updatePending(false),
+      draggingMinimap(false),
+      pressedPosition(-1)
+{
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+}
+
+void BoardView::resetBoard(int rows, int cols)
+{
+    this->rows = rows;
+    this->cols = cols;
+
+    levels.clear();
+    QImage cells(qMax(1, cols), qMax(1, rows), QImage::Format_Indexed8);
+    cells.setColorTable(stateColorTable());
+    cells.fill(uint(Hidden));
+    levels.push_back(cells);
+    int width = cells.width(), height = cells.height();
+    while (qMax(width, height) > MinimapSize) {
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+        QImage level(width, height, QImage::Format_RGB32);
+        level.fill(HiddenColor);
+        levels.push_back(level);
+    }
+
+    // 默认 50 像素一格；放不下屏幕时缩小到刚好能看到整个棋盘
+    QRect available = QApplication::desktop()->availableGeometry(this);
+    double fit = qMin(available.width() * 0.8 / qMax(1, cols),
+                      available.height() * 0.7 / qMax(1, rows));
+    cellSize = qMin(double(DefaultCellSize), fit);
+
+    updateScrollBars();
+    horizontalScrollBar()->setValue(0);
+    verticalScrollBar()->setValue(0);
+    updateGeometry();
+    viewport()->update();
+}
+
+void BoardView::setCellState(int row, int col, int state)
+{
+    uchar* cell = levels[0].scanLine(row) + col;
+    if (*cell == state) return;
+    *cell = uchar(state);
+    updateLevels(row, col);
+
+    // 一次展开可能改动大量格子，合并成一次重绘
+    if (!updatePending) {
+        updatePending = true;
+        QTimer::singleShot(0, this, SLOT(flushUpdate()));
+    }
+}
+
+void BoardView::flushUpdate()
+{
+    updatePending = false;
+    viewport()->update();
+}
+
+void BoardView::updateLevels(int row, int col)
+{
+    // 逐级重算所在的那个像素（2x2 子像素取平均），颜色不变就不必再往上算
+    for (int k = 1; k < int(levels.size()); ++k) {
+        row /= 2;
+        col /= 2;
+        const QImage& child = levels[k - 1];
+        int lastRow = qMin(2 * row + 1, child.height() - 1);
+        int lastCol = qMin(2 * col + 1, child.width() - 1);
+
+        int red = 0, green = 0, blue = 0, count = 0;
+        for (int y = 2 * row; y <= lastRow; ++y) {
+            for (int x = 2 * col; x <= lastCol; ++x) {
+                QRgb color = k == 1 ? child.color(child.constScanLine(y)[x])
+                                    : reinterpret_cast<const QRgb*>(child.constScanLine(y))[x];
+                red += qRed(color);
+                green += qGreen(color);
+                blue += qBlue(color);
+                count++;
+            }
+        }
+
+        QRgb* pixel = reinterpret_cast<QRgb*>(levels[k].scanLine(row)) + col;
+        QRgb average = qRgb(red / count, green / count, blue / count);
+        if (*pixel == average) return;
+        *pixel = average;
+    }
+}
+
+int BoardView::levelFor(double pixelsPerCell) const
+{
+    // 取每个像素至少占 1 个屏幕像素的最精细层级
+    int level = 0;
+    while (level + 1 < int(levels.size()) && pixelsPerCell * (1 << level) < 1.0) level++;
+    return level;
+}
+
+QSize BoardView::sizeHint() const
+{
+    QRect available = QApplication::desktop()->availableGeometry(this);
+    QSize content = contentSize();
+    int frame = 2 * frameWidth();
+    return QSize(qMin(content.width(), int(available.width() * 0.8)) + frame,
+                 qMin(content.height(), int(available.height() * 0.7)) + frame);
+}
+
+QSize BoardView::contentSize() const
+{
+    return QSize(int(std::ceil(cols * cellSize)), int(std::ceil(rows * cellSize)));
+}
+
+QPointF BoardView::boardOrigin() const
+{
+    QSize content = contentSize();
+    QSize view = viewport()->size();
+    double x = content.width() < view.width() ? (view.width() - content.width()) / 2.0
+                                              : -horizontalScrollBar()->value();
+    double y = content.height() < view.height() ? (view.height() - content.height()) / 2.0
+                                                : -verticalScrollBar()->value();
+    return QPointF(x, y);
+}
+
+double BoardView::minCellSize() const
+{
+    if (rows == 0 || cols == 0) return DetailCellSize;
+    QSize view = viewport()->size();
+    double fit = qMin(double(view.width()) / cols, double(view.height()) / rows);
+    return qMin(fit, double(DetailCellSize));
+}
+
+void BoardView::updateScrollBars()
+{
+    QSize content = contentSize();
+    QSize view = viewport()->size();
+    int step = qMax(1, int(cellSize));
+
+    horizontalScrollBar()->setRange(0, qMax(0, content.width() - view.width()));
+    horizontalScrollBar()->setPageStep(view.width());
+    horizontalScrollBar()->setSingleStep(step);
+    verticalScrollBar()->setRange(0, qMax(0, content.height() - view.height()));
+    verticalScrollBar()->setPageStep(view.height());
+    verticalScrollBar()->setSingleStep(step);
+}
+
+void BoardView::setZoom(double size, const QPoint& anchor)
+{
+    size = qBound(minCellSize(), size, double(MaxCellSize));
+    if (size == cellSize) return;
+
+    // 保持鼠标下的那一格不动
+    QPointF origin = boardOrigin();
+    double cellX = (anchor.x() - origin.x()) / cellSize;
+    double cellY = (anchor.y() - origin.y()) / cellSize;
+
+    cellSize = size;
+    updateScrollBars();
+    horizontalScrollBar()->setValue(int(cellX * cellSize - anchor.x()));
+    verticalScrollBar()->setValue(int(cellY * cellSize - anchor.y()));
+    viewport()->update();
+}
+
+void BoardView::centerOn(double boardX, double boardY)
+{
+    QSize view = viewport()->size();
+    horizontalScrollBar()->setValue(int(boardX - view.width() / 2.0));
+    verticalScrollBar()->setValue(int(boardY - view.height() / 2.0));
+}
+
+int BoardView::positionAt(const QPoint& point) const
+{
+    QPointF origin = boardOrigin();
+    int col = int(std::floor((point.x() - origin.x()) / cellSize));
+    int row = int(std::floor((point.y() - origin.y()) / cellSize));
+    if (row < 0 || row >= rows || col < 0 || col >= cols) return -1;
+    return row * cols + col;
+}
+
+QRect BoardView::minimapRect() const
+{
+    QSize content = contentSize();
+    QSize view = viewport()->size();
+    if (rows == 0 || cols == 0 ||
+        (content.width() <= view.width() && content.height() <= view.height()))
+        return QRect();
+
+    double scale = double(MinimapSize) / qMax(rows, cols);
+    int width = qMax(1, int(cols * scale));
+    int height = qMax(1, int(rows * scale));
+    return QRect(view.width() - width - 10, view.height() - height - 10, width, height);
+}
+
+void BoardView::paintEvent(QPaintEvent *event)
+{
+    QPainter painter(viewport());
+    QRect area = event->rect();
+    painter.fillRect(area, palette().window());
+    if (levels.empty()) return;
+
+    if (cellSize >= DetailCellSize) {
+        drawCells(painter, area);
+    } else {
+        drawBlocks(painter, area);
+    }
+    drawMinimap(painter);
+}
+
+void BoardView::drawCells(QPainter& painter, const QRect& area)
+{
+    QPointF origin = boardOrigin();
+    int firstCol = qMax(0, int(std::floor((area.left() - origin.x()) / cellSize)));
+    int lastCol = qMin(cols - 1, int(std::floor((area.right() - origin.x()) / cellSize)));
+    int firstRow = qMax(0, int(std::floor((area.top() - origin.y()) / cellSize)));
+    int lastRow = qMin(rows - 1, int(std::floor((area.bottom() - origin.y()) / cellSize)));
+
+    // 先按状态分桶，每种状态只设一次画刷/画笔、一次 drawRects
+    std::vector<QVector<QRect> > byState(StateCount);
+    for (int i = firstRow; i <= lastRow; ++i) {
+        int top = int(origin.y() + i * cellSize);
+        int bottom = int(origin.y() + (i + 1) * cellSize);
+        const uchar* rowStates = levels[0].constScanLine(i);
+        for (int j = firstCol; j <= lastCol; ++j) {
+            int left = int(origin.x() + j * cellSize);
+            int right = int(origin.x() + (j + 1) * cellSize);
+            byState[rowStates[j]].append(QRect(left, top, right - left, bottom - top));
+        }
+    }
+
+    painter.setPen(Qt::NoPen);
+    for (int state = 0; state < StateCount; ++state) {
+        if (byState[state].isEmpty()) continue;
+        painter.setBrush(QColor(stateColor(state)));
+        painter.drawRects(byState[state]);
+    }
+
+    if (cellSize >= 12) {
+        QVector<QRect> hiddenBorders, revealedBorders;
+        for (int state = 0; state < StateCount; ++state) {
+            QVector<QRect>& borders = isRevealedState(state) ? revealedBorders : hiddenBorders;
+            for (const QRect& rect : byState[state]) borders.append(rect.adjusted(0, 0, -1, -1));
+        }
+        painter.setBrush(Qt::NoBrush);
+        painter.setPen(QColor(HiddenBorderColor));
+        painter.drawRects(hiddenBorders);
+        painter.setPen(QColor(RevealedBorderColor));
+        painter.drawRects(revealedBorders);
+    }
+
+    if (cellSize >= 14) {
+        QFont font = painter.font();
+        font.setPixelSize(qMax(8, int(cellSize * 0.4)));
+        painter.setFont(font);
+
+        for (int state = 0; state < StateCount; ++state) {
+            if (byState[state].isEmpty()) continue;
+            QString text = stateText(state);
+            if (text.isEmpty()) continue;
+            painter.setPen(QColor(stateTextColor(state)));
+            for (const QRect& rect : byState[state]) painter.drawText(rect, Qt::AlignCenter, text);
+        }
+    }
+}
+
+void BoardView::drawBlocks(QPainter& painter, const QRect& area)
+{
+    // 缩小时把状态图按最近邻缩放到屏幕上：每格还有 1 像素以上就逐格显示，
+    // 更小时才用聚合层级。只裁出可见部分绘制，代价只和可见像素数有关
+    QPointF origin = boardOrigin();
+    QRectF boardRect(origin, QSizeF(cols * cellSize, rows * cellSize));
+    QRectF target = boardRect.intersected(QRectF(area));
+    if (target.isEmpty()) return;
+
+    int level = levelFor(cellSize);
+    const QImage& image = levels[level];
+    double pixelSize = cellSize * (1 << level);
+    QRectF source((target.left() - origin.x()) / pixelSize,
+                  (target.top() - origin.y()) / pixelSize,
+                  target.width() / pixelSize,
+                  target.height() / pixelSize);
+    QRect visible = source.toAlignedRect().intersected(image.rect());
+    painter.drawImage(target, image.copy(visible), source.translated(-visible.topLeft()));
+}
+
+void BoardView::drawMinimap(QPainter& painter)
+{
+    QRect rect = minimapRect();
+    if (rect.isEmpty()) return;
+
+    painter.fillRect(rect.adjusted(-2, -2, 2, 2), QColor(255, 255, 255, 200));
+    int level = levelFor(double(rect.width()) / cols);
+    double cellsPerPixel = 1 << level;
+    painter.drawImage(QRectF(rect), levels[level],
+                      QRectF(0, 0, cols / cellsPerPixel, rows / cellsPerPixel));
+
+    // 当前可见范围
+    QPointF origin = boardOrigin();
+    QSize view = viewport()->size();
+    double scale = double(rect.width()) / cols;
+    QRectF visible(rect.left() + qMax(0.0, -origin.x()) / cellSize * scale,
+                   rect.top() + qMax(0.0, -origin.y()) / cellSize * scale,
+                   view.width() / cellSize * scale,
+                   view.height() / cellSize * scale);
+    painter.setPen(Qt::red);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(visible.intersected(QRectF(rect)));
+}
+
+void BoardView::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+}
+
+void BoardView::mousePressEvent(QMouseEvent *event)
+{
+    QRect minimap = minimapRect();
+    if (event->button() == Qt::LeftButton && minimap.contains(event->pos())) {
+        draggingMinimap = true;
+        mouseMoveEvent(event);
+        return;
+    }
+
+    pressedPosition = positionAt(event->pos());
+    if (event->button() == Qt::RightButton && pressedPosition >= 0 && cellSize >= DetailCellSize) {
+        emit cellRightClicked(pressedPosition);
+    }
+}
+
+void BoardView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (!draggingMinimap) return;
+
+    QRect minimap = minimapRect();
+    if (minimap.isEmpty()) return;
+    double scale = double(minimap.width()) / cols;
+    double cellX = (event->pos().x() - minimap.left()) / scale;
+    double cellY = (event->pos().y() - minimap.top()) / scale;
+    centerOn(cellX * cellSize, cellY * cellSize);
+}
+
+void BoardView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (draggingMinimap) {
+        draggingMinimap = false;
+        return;
+    }
+    if (event->button() != Qt::LeftButton) return;
+
+    int position = positionAt(event->pos());
+    if (position < 0 || position != pressedPosition) return;
+
+    // 缩放绘制模式下格子太小，左键先放大到可以操作的尺寸
+    if (cellSize < DetailCellSize) {
+        setZoom(3 * DetailCellSize, event->pos());
+    } else {
+        emit cellLeftClicked(position);
+    }
+}
+
+void BoardView::wheelEvent(QWheelEvent *event)
+{
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        QAbstractScrollArea::wheelEvent(event);
+        return;
+    }
+
+    double factor = event->angleDelta().y() > 0 ? 1.25 : 0.8;
+    setZoom(cellSize * factor, event->pos());
+    event->accept();
+}
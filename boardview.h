@@ -0,0 +1,73 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+#include <QAbstractScrollArea>
+#include <QImage>
+#include <vector>
+
+// 可滚动、可缩放的棋盘视图：只绘制和命中测试可见范围内的格子，
+// 缩小后直接缩放每格一像素的状态图，不到 1 像素一格时才改用聚合层级，
+// 并在角落显示小地图
+class BoardView : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    enum CellState {
+        Hidden = 0,
+        Flagged,
+        Mine,
+        Exploded,
+        WrongFlag,
+        SafeFlag,
+        Revealed = 16   // Revealed + n：已翻开且周围有 n 个雷
+    };
+
+    explicit BoardView(QWidget *parent = nullptr);
+
+    void resetBoard(int rows, int cols);
+    void setCellState(int row, int col, int state);
+    int cellState(int row, int col) const { return levels[0].constScanLine(row)[col]; }
+
+    QSize sizeHint() const override;
+
+    static const int DetailCellSize = 8;    // 格子小于此像素时缩放状态图绘制
+    static const int MaxCellSize = 64;
+    static const int DefaultCellSize = 50;
+    static const int MinimapSize = 160;
+signals:
+    void cellLeftClicked(int position);
+    void cellRightClicked(int position);
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+private slots:
+    void flushUpdate();
+private:
+    int rows, cols;
+    double cellSize;
+    // levels[0] 每格一个像素，索引即格子状态；levels[k] 每像素为 2^k x 2^k 格的平均色，
+    // 逐级减半直到不超过小地图大小。缩小绘制和小地图共用
+    std::vector<QImage> levels;
+    bool updatePending;
+    bool draggingMinimap;
+    int pressedPosition;
+
+    QSize contentSize() const;
+    QPointF boardOrigin() const;
+    QRect minimapRect() const;
+    double minCellSize() const;
+    int positionAt(const QPoint& point) const;
+    void setZoom(double size, const QPoint& anchor);
+    void centerOn(double boardX, double boardY);
+    void updateScrollBars();
+    void updateLevels(int row, int col);
+    int levelFor(double pixelsPerCell) const;
+    void drawCells(QPainter& painter, const QRect& area);
+    void drawBlocks(QPainter& painter, const QRect& area);
+    void drawMinimap(QPainter& painter);
+};
+
+#endif // BOARDVIEW_H
@@ -0,0 +1,300 @@
+#include "gamesaver.h"
+#include <QFile>
+#include <QSaveFile>
+#include <QtConcurrent>
+#include <QDebug>
+#include <QtAlgorithms>
+#include <cstring>
+
+namespace {
+
+const quint32 SaveVersion = 3;
+
+struct SaveHeader {
+    char magic[4];
+    quint32 version;
+    qint32 rows;
+    qint32 cols;
+    qint32 numMines;
+    qint32 difficulty;
+    qint64 elapsedMs;
+    qint32 challengeMode;
+    qint32 challengeSecondsRemaining;
+    quint32 seed;
+    qint32 clickRow;
+    qint32 clickCol;
+    quint32 reserved;
+};
+
+const int HeaderSize = int(sizeof(SaveHeader));
+
+}
+
+GameSaver::GameSaver(const QString& filePath, QObject *parent)
+    : QObject(parent),
+      filePath(filePath),
+      sectionBytes(0),
+      fullWriteNeeded(true)
+{
+}
+
+GameSaver::~GameSaver()
+{
+    pendingWrite.waitForFinished();
+}
+
+void GameSaver::reset(int rows, int cols)
+{
+    sectionBytes = (rows * cols + 7) / 8;
+    int size = HeaderSize + 3 * sectionBytes;
+    image = QByteArray(size, 0);
+    dirtyBlocks.assign((size + BlockSize - 1) / BlockSize, false);
+    fullWriteNeeded = true;
+}
+
+void GameSaver::reset(int rows, int cols, const QByteArray& mineBits)
+{
+    reset(rows, cols);
+    std::memcpy(image.data() + HeaderSize + MineSection * sectionBytes,
+                mineBits.constData(), qMin(sectionBytes, mineBits.size()));
+}
+
+QByteArray GameSaver::packBits(const std::vector<char>& values)
+{
+    int count = int(values.size());
+    QByteArray bits((count + 7) / 8, 0);
+    char* data = bits.data();
+    for (int pos = 0; pos < count; ++pos) {
+        if (values[pos]) data[pos / 8] |= char(1 << (pos % 8));
+    }
+    return bits;
+}
+
+std::vector<char> GameSaver::unpackBits(const QByteArray& bits, int count)
+{
+    std::vector<char> values(count);
+    const char* data = bits.constData();
+    for (int pos = 0; pos < count; ++pos) {
+        values[pos] = (data[pos / 8] >> (pos % 8)) & 1;
+    }
+    return values;
+}
+
+void GameSaver::setBit(Section section, int pos, bool value)
+{
+    int offset = HeaderSize + section * sectionBytes + pos / 8;
+    char mask = char(1 << (pos % 8));
+    char old = image.constData()[offset];
+    char updated = value ? char(old | mask) : char(old & ~mask);
+    if (updated == old) return;
+
+    image.data()[offset] = updated;
+    markDirty(offset, 1);
+}
+
+bool GameSaver::testBit(Section section, int pos) const
+{
+    int offset = HeaderSize + section * sectionBytes + pos / 8;
+    return (image.constData()[offset] >> (pos % 8)) & 1;
+}
+
+void GameSaver::markDirty(int offset, int length)
+{
+    for (int block = offset / BlockSize; block <= (offset + length - 1) / BlockSize; ++block) {
+        dirtyBlocks[block] = true;
+    }
+}
+
+void GameSaver::writeHeader(const State& state)
+{
+    SaveHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "SLSV", 4);
+    header.version = SaveVersion;
+    header.rows = state.rows;
+    header.cols = state.cols;
+    header.numMines = state.numMines;
+    header.difficulty = state.difficulty;
+    header.elapsedMs = state.elapsedMs;
+    header.challengeMode = state.challengeMode ? 1 : 0;
+    header.challengeSecondsRemaining = state.challengeSecondsRemaining;
+    header.seed = state.seed;
+    header.clickRow = state.clickRow;
+    header.clickCol = state.clickCol;
+
+    if (std::memcmp(image.constData(), &header, HeaderSize) == 0) return;
+    std::memcpy(image.data(), &header, HeaderSize);
+    markDirty(0, HeaderSize);
+}
+
+QList<GameSaver::Chunk> GameSaver::takeDirtyChunks(bool& truncate)
+{
+    QList<Chunk> chunks;
+    truncate = fullWriteNeeded || !QFile::exists(filePath);
+
+    if (truncate) {
+        // 整体写：共享同一份镜像（写时复制），一次 write 落盘
+        Chunk chunk;
+        chunk.offset = 0;
+        chunk.data = image;
+        chunks.append(chunk);
+        fullWriteNeeded = false;
+    } else {
+        // 增量写：相邻的脏块合并成一段
+        int blocks = int(dirtyBlocks.size());
+        for (int block = 0; block < blocks; ++block) {
+            if (!dirtyBlocks[block]) continue;
+            int first = block;
+            while (block + 1 < blocks && dirtyBlocks[block + 1]) block++;
+
+            Chunk chunk;
+            chunk.offset = qint64(first) * BlockSize;
+            chunk.data = image.mid(first * BlockSize, (block - first + 1) * BlockSize);
+            chunks.append(chunk);
+        }
+    }
+
+    std::fill(dirtyBlocks.begin(), dirtyBlocks.end(), false);
+    return chunks;
+}
+
+void GameSaver::writeChunks(const QString& path, const QList<Chunk>& chunks, bool truncate)
+{
+    if (truncate) {
+        // 整体写入先写临时文件再替换，写到一半崩溃或被杀也不会毁掉原存档
+        QSaveFile file(path);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qDebug() << "无法写入文件:" << path;
+            return;
+        }
+        for (const auto& chunk : chunks) {
+            if (!file.seek(chunk.offset) || file.write(chunk.data) != chunk.data.size()) {
+                qDebug() << "写入存档失败:" << path;
+                file.cancelWriting();
+                return;
+            }
+        }
+        if (!file.commit()) qDebug() << "写入存档失败:" << path;
+        return;
+    }
+
+    // 增量自动保存只就地改写脏块
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << "无法写入文件:" << path;
+        return;
+    }
+
+    for (const auto& chunk : chunks) {
+        if (!file.seek(chunk.offset) || file.write(chunk.data) != chunk.data.size()) {
+            qDebug() << "写入存档失败:" << path;
+            break;
+        }
+    }
+
+    file.close();
+}
+
+void GameSaver::save(const State& state)
+{
+    if (image.isEmpty()) return;
+    pendingWrite.waitForFinished();
+
+    writeHeader(state);
+    bool truncate;
+    QList<Chunk> chunks = takeDirtyChunks(truncate);
+    if (!chunks.isEmpty()) writeChunks(filePath, chunks, truncate);
+}
+
+void GameSaver::saveAsync(const State& state)
+{
+    // 上一次还没写完就等下一轮，脏块标记会保留下来
+    if (image.isEmpty() || pendingWrite.isRunning()) return;
+
+    writeHeader(state);
+    bool truncate;
+    QList<Chunk> chunks = takeDirtyChunks(truncate);
+    if (chunks.isEmpty()) return;
+
+    QString path = filePath;
+    pendingWrite = QtConcurrent::run([path, chunks, truncate]() {
+        writeChunks(path, chunks, truncate);
+    });
+}
+
+bool GameSaver::hasSave() const
+{
+    return QFile::exists(filePath);
+}
+
+bool GameSaver::load(State& state)
+{
+    pendingWrite.waitForFinished();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qDebug() << "无法打开文件:" << filePath;
+        return false;
+    }
+
+    qint64 size = file.size();
+    if (size < HeaderSize) return false;
+    uchar* data = file.map(0, size);
+    if (!data) return false;
+
+    // 尺寸和地雷数按自定义对话框的范围校验，地雷数还须与位图一致，
+    // 否则胜负判定会出错，生成布局时也可能死循环
+    SaveHeader header;
+    std::memcpy(&header, data, HeaderSize);
+    bool valid = std::memcmp(header.magic, "SLSV", 4) == 0 &&
+                 header.version == SaveVersion &&
+                 header.rows >= 9 && header.rows <= 5000 &&
+                 header.cols >= 9 && header.cols <= 5000 &&
+                 header.numMines >= 1 && header.numMines <= header.rows * header.cols - 9 &&
+                 size == HeaderSize + 3 * qint64((header.rows * header.cols + 7) / 8);
+    if (valid) {
+        // 同一遍里顺带检查：翻开的格子不能是雷，也不能同时插着旗
+        int cells = header.rows * header.cols;
+        int bytes = (cells + 7) / 8;
+        const uchar* mineSection = data + HeaderSize + MineSection * bytes;
+        const uchar* revealedSection = data + HeaderSize + RevealedSection * bytes;
+        const uchar* flaggedSection = data + HeaderSize + FlaggedSection * bytes;
+        int mines = 0;
+        uchar conflicts = 0;
+        for (int i = 0; i < bytes; ++i) {
+            uchar mask = (i == bytes - 1 && cells % 8) ? uchar((1 << (cells % 8)) - 1) : uchar(0xff);
+            uchar mine = mineSection[i] & mask;
+            uchar revealed = revealedSection[i] & mask;
+            mines += qPopulationCount(quint8(mine));
+            conflicts |= (revealed & mine) | (revealed & flaggedSection[i]);
+        }
+        valid = mines == header.numMines && conflicts == 0;
+    }
+    if (valid) {
+        reset(header.rows, header.cols);
+        std::memcpy(image.data(), data, size);
+    }
+
+    file.unmap(data);
+    file.close();
+    if (!valid) return false;
+
+    state.rows = header.rows;
+    state.cols = header.cols;
+    state.numMines = header.numMines;
+    state.difficulty = header.difficulty;
+    state.elapsedMs = header.elapsedMs;
+    state.challengeMode = header.challengeMode != 0;
+    state.challengeSecondsRemaining = header.challengeSecondsRemaining;
+    state.seed = header.seed;
+    state.clickRow = header.clickRow;
+    state.clickCol = header.clickCol;
+    return true;
+}
+
+void GameSaver::remove()
+{
+    pendingWrite.waitForFinished();
+    QFile::remove(filePath);
+    fullWriteNeeded = true;
+}
@@ -0,0 +1,81 @@
+#ifndef GAMESAVER_H
+#define GAMESAVER_H
+#include <QObject>
+#include <QByteArray>
+#include <QFuture>
+#include <QList>
+#include <QString>
+#include <vector>
+
+// 进行中对局的存档：文件头 + 地雷/已翻开/旗子三段位图。
+// 内存里保存一份和文件完全一致的镜像，整体保存时写临时文件后替换，
+// 自动保存只在后台线程重写改动过的块，读档用 mmap
+class GameSaver : public QObject
+{
+    Q_OBJECT
+public:
+    struct State {
+        int rows;
+        int cols;
+        int numMines;
+        int difficulty;
+        qint64 elapsedMs;
+        bool challengeMode;
+        int challengeSecondsRemaining;
+        quint32 seed;
+        int clickRow;     // 首击位置，和 seed 一起才能复现棋盘
+        int clickCol;
+    };
+
+    explicit GameSaver(const QString& filePath, QObject *parent = nullptr);
+    ~GameSaver();
+
+    void reset(int rows, int cols);
+    void reset(int rows, int cols, const QByteArray& mineBits);
+
+    // 按存档的位序打包，可在后台线程预先做好
+    static QByteArray packBits(const std::vector<char>& values);
+    static std::vector<char> unpackBits(const QByteArray& bits, int count);
+
+    void setMine(int pos, bool value) { setBit(MineSection, pos, value); }
+    void setRevealed(int pos, bool value) { setBit(RevealedSection, pos, value); }
+    void setFlagged(int pos, bool value) { setBit(FlaggedSection, pos, value); }
+    bool isMine(int pos) const { return testBit(MineSection, pos); }
+    bool isRevealed(int pos) const { return testBit(RevealedSection, pos); }
+    bool isFlagged(int pos) const { return testBit(FlaggedSection, pos); }
+
+    bool hasSave() const;
+    bool load(State& state);
+    void save(const State& state);
+    void saveAsync(const State& state);
+    void remove();
+
+    static const int BlockSize = 4096;
+private:
+    enum Section {
+        MineSection,
+        RevealedSection,
+        FlaggedSection
+    };
+
+    struct Chunk {
+        qint64 offset;
+        QByteArray data;
+    };
+
+    QString filePath;
+    QByteArray image;
+    int sectionBytes;
+    std::vector<bool> dirtyBlocks;
+    bool fullWriteNeeded;
+    QFuture<void> pendingWrite;
+
+    void setBit(Section section, int pos, bool value);
+    bool testBit(Section section, int pos) const;
+    void writeHeader(const State& state);
+    void markDirty(int offset, int length);
+    QList<Chunk> takeDirtyChunks(bool& truncate);
+    static void writeChunks(const QString& path, const QList<Chunk>& chunks, bool truncate);
+};
+
+#endif // GAMESAVER_H
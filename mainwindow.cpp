@@ -2,12 +2,14 @@
 #include <QApplication>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
-#include <QGridLayout>
 #include <QMessageBox>
 #include <QDesktopWidget>
 #include <cstdlib>
 #include <ctime>
 #include <QInputDialog>
+#include <QTabWidget>
+#include <QCloseEvent>
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent),
@@ -15,9 +17,20 @@ MainWindow::MainWindow(QWidget *parent)
       secondsElapsed(0),
       gameOver(false),
       gameStarted(false),
+      customRows(30),
+      customCols(30),
+      customMines(150),
+      revealedCount(0),
+      flaggedCount(0),
+      board3BV(0),
+      boardPrefetcher(new BoardPrefetcher(this)),
+      boardSeed(0),
+      waitingForBoard(false),
+      openingsPending(false),
+      gameSaver(new GameSaver("minesweeper_save.bin", this)),
+      autosaveTimer(new QTimer(this)),
+      elapsedBaseMs(0),
       currentDifficulty(Beginner),
-      leftClickMapper(new QSignalMapper(this)),
-      rightClickMapper(new QSignalMapper(this)),
       isFirstClick(true),
       timeRecorder(new TimeRecorder(this)),
     challengeTimer(nullptr),
@@ -25,17 +38,34 @@ MainWindow::MainWindow(QWidget *parent)
           isChallengeMode(false)
 {
     setWindowTitle("扫雷");
-    setWindowFlags(windowFlags() & ~Qt::WindowMaximizeButtonHint);
     setupUI();
 
-    connect(difficultyCombo, SIGNAL(currentIndexChanged(int)), this, SLOT(onDifficultyChanged(int)));
+    // 用 activated 而不是 currentIndexChanged，再次选中“自定义”也能重新设置尺寸
+    connect(difficultyCombo, SIGNAL(activated(int)), this, SLOT(onDifficultyChanged(int)));
     connect(resetButton, SIGNAL(clicked()), this, SLOT(onResetButtonClicked()));
     connect(timer, SIGNAL(timeout()), this, SLOT(updateTimer()));
-    connect(leftClickMapper, SIGNAL(mapped(int)), this, SLOT(onButtonClicked(int)));
-    connect(rightClickMapper, SIGNAL(mapped(int)), this, SLOT(onRightClick(int)));
+    connect(boardView, SIGNAL(cellLeftClicked(int)), this, SLOT(onButtonClicked(int)));
+    connect(boardView, SIGNAL(cellRightClicked(int)), this, SLOT(onRightClick(int)));
+
+    connect(autosaveTimer, SIGNAL(timeout()), this, SLOT(autosave()));
+    connect(boardPrefetcher, &BoardPrefetcher::boardPrepared, this, &MainWindow::onBoardPrepared);
+    connect(boardPrefetcher, &BoardPrefetcher::openingsReady, this, &MainWindow::onOpeningsReady);
 
     setDifficulty(Beginner);
-    resetGame();
+
+    bool resumed = false;
+    if (gameSaver->hasSave()) {
+        int result = QMessageBox::question(
+            this,
+            "继续游戏",
+            "发现上次未完成的游戏，是否继续？",
+            QMessageBox::Yes | QMessageBox::No,
+            QMessageBox::Yes
+        );
+        if (result == QMessageBox::Yes) resumed = resumeGame();
+    }
+    if (!resumed) resetGame();
+    autosaveTimer->start(10000);
 
     adjustSize();
 
@@ -74,10 +104,11 @@ void MainWindow::setupUI()
     difficultyCombo->addItem("初级");
     difficultyCombo->addItem("中级");
     difficultyCombo->addItem("高级");
+    difficultyCombo->addItem("自定义");
     topLayout->addWidget(difficultyCombo);
 
     mineCountLabel = new QLabel("000", this);
-    mineCountLabel->setFixedWidth(50);
+    mineCountLabel->setMinimumWidth(50);
     topLayout->addWidget(mineCountLabel);
 
     resetButton = new QPushButton("🙂", this);
@@ -92,18 +123,19 @@ void MainWindow::setupUI()
     topLayout->addWidget(recordsButton);
     connect(recordsButton, &QPushButton::clicked, this, &MainWindow::onRecordsButtonClicked);
 
+    QPushButton* statsButton = new QPushButton("统计", this);
+    topLayout->addWidget(statsButton);
+    connect(statsButton, &QPushButton::clicked, this, &MainWindow::onStatsButtonClicked);
+
     challengeButton = new QPushButton("挑战", this);
     topLayout->addWidget(challengeButton);
     connect(challengeButton, &QPushButton::clicked, this, &MainWindow::onChallengeButtonClicked);
 
     mainLayout->addWidget(topWidget);
 
-    QGridLayout *gridLayout = new QGridLayout();
-    gridLayout->setHorizontalSpacing(0);
-    gridLayout->setVerticalSpacing(0);
-    gridLayout->setMargin(0);
-    gridLayout->setSizeConstraint(QLayout::SetFixedSize);
-    mainLayout->addLayout(gridLayout);
+    // 棋盘视图只绘制可见范围，Ctrl+滚轮缩放
+    boardView = new BoardView(this);
+    mainLayout->addWidget(boardView, 1);
 
 
 }
@@ -151,6 +183,8 @@ void MainWindow::updateChallengeTimer()
     } else {
         challengeTimer->stop();
         gameOver = true;
+        gameSaver->remove();
+        timeRecorder->addLoss(getRecordDifficulty());
         revealAllMines();
         resetButton->setText("😞");
         QMessageBox::critical(this, "挑战失败", "时间已用完！");
@@ -169,47 +203,40 @@ void MainWindow::setDifficulty(Difficulty diff)
         case Expert:
             rows = 16; cols = 30; numMines = 99;
             break;
+        case Custom:
+            rows = customRows; cols = customCols; numMines = customMines;
+            break;
     }
 }
 
-void MainWindow::initBoard()
+bool MainWindow::askCustomSize()
 {
-    QGridLayout *gridLayout = dynamic_cast<QGridLayout*>(centralWidget->layout()->itemAt(1));
-    if (!gridLayout) return;
-
-    while (gridLayout->count() > 0) {
-        QLayoutItem* item = gridLayout->takeAt(0);
-        if (QWidget* widget = item->widget()) {
-            delete widget;
-        }
-        delete item;
-    }
+    bool ok;
+    int newRows = QInputDialog::getInt(this, "自定义", "行数:", customRows, 9, 5000, 1, &ok);
+    if (!ok) return false;
+    int newCols = QInputDialog::getInt(this, "自定义", "列数:", customCols, 9, 5000, 1, &ok);
+    if (!ok) return false;
+    // 首击周围 3x3 不放雷，最多只能放 rows*cols-9 个
+    int maxMines = newRows * newCols - 9;
+    int newMines = QInputDialog::getInt(this, "自定义", "地雷数:",
+                                        qMin(customMines, maxMines), 1, maxMines, 1, &ok);
+    if (!ok) return false;
+
+    customRows = newRows;
+    customCols = newCols;
+    customMines = newMines;
+    return true;
+}
 
-    board.clear();
-    board.resize(rows, std::vector<Cell>(cols));
+void MainWindow::initBoard()
+{
+    Cell empty = {false, false};
+    board.assign(rows, std::vector<Cell>(cols, empty));
+    cellNumbers.clear();
+    revealedCount = 0;
+    flaggedCount = 0;
 
-    int btnSize = 50;
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            board[i][j].button = new QPushButton(this);
-            board[i][j].button->setFixedSize(btnSize, btnSize);
-            board[i][j].button->setStyleSheet("border: 1px solid gray; background-color: #ccc;");
-            gridLayout->addWidget(board[i][j].button, i, j);
-
-            int position = i * cols + j;
-            connect(board[i][j].button, SIGNAL(clicked()), leftClickMapper, SLOT(map()));
-            leftClickMapper->setMapping(board[i][j].button, position);
-
-            board[i][j].button->setContextMenuPolicy(Qt::CustomContextMenu);
-            connect(board[i][j].button, SIGNAL(customContextMenuRequested(const QPoint&)), rightClickMapper, SLOT(map()));
-            rightClickMapper->setMapping(board[i][j].button, position);
-
-            board[i][j].isMine = false;
-            board[i][j].isRevealed = false;
-            board[i][j].isFlagged = false;
-            board[i][j].adjacentMines = 0;
-        }
-    }
+    boardView->resetBoard(rows, cols);
 
     updateMineCount();
     centralWidget->layout()->activate();
@@ -217,80 +244,81 @@ void MainWindow::initBoard()
 }
 
 
-void MainWindow::calculateAdjacentMines()
-{
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            if (board[i][j].isMine) continue;
-
-            int count = 0;
-            for (int x = qMax(0, i-1); x <= qMin(rows-1, i+1); ++x) {
-                for (int y = qMax(0, j-1); y <= qMin(cols-1, j+1); ++y) {
-                    if (board[x][y].isMine) count++;
-                }
-            }
-            board[i][j].adjacentMines = count;
-        }
-    }
-}
-
 void MainWindow::revealCell(int row, int col)
 {
     if (row < 0 || row >= rows || col < 0 || col >= cols ||
         board[row][col].isRevealed || board[row][col].isFlagged)
         return;
 
-    board[row][col].isRevealed = true;
-    board[row][col].button->setEnabled(false);
-
-    if (board[row][col].isMine) {
-        board[row][col].button->setText("*");
-        board[row][col].button->setStyleSheet("background-color: red; color: black;");
+    if (cellNumbers[row * cols + col] < 0) {
+        board[row][col].isRevealed = true;
         revealAllMines();
+        boardView->setCellState(row, col, BoardView::Exploded);
         gameOver = true;
+        gameSaver->remove();
         timer->stop();
+        if (challengeTimer) challengeTimer->stop();
+        timeRecorder->addLoss(getRecordDifficulty());
         resetButton->setText("😞");
         QMessageBox::critical(this, "游戏结束", "踩到地雷了！");
         return;
     }
 
-    board[row][col].button->setStyleSheet("border: 1px solid #888; background-color: #eee;");
-
-    if(board[row][col].adjacentMines > 0) {
-        board[row][col].button->setText(QString::number(board[row][col].adjacentMines));
-        QString color;
-        switch (board[row][col].adjacentMines) {
-            case 1: color = "blue"; break;
-            case 2: color = "green"; break;
-            case 3: color = "red"; break;
-            case 4: color = "darkblue"; break;
-            case 5: color = "darkred"; break;
-            case 6: color = "cyan"; break;
-            case 7: color = "black"; break;
-            case 8: color = "gray"; break;
-            default: color = "black";
-        }
-        board[row][col].button->setStyleSheet(QString("color: %1; font-size: 20px;").arg(color));
-    } else {
-        for (int x = qMax(0, row-1); x <= qMin(rows-1, row+1); ++x) {
-            for (int y = qMax(0, col-1); y <= qMin(cols-1, col+1); ++y) {
-                revealCell(x, y);
+    if (cellNumbers[row * cols + col] > 0) {
+        showSafeCell(row, col);
+        return;
+    }
+
+    if (openingsPending) {
+        // 空白区索引还在后台重建，先逐格向外展开
+        std::vector<int> pending(1, row * cols + col);
+        while (!pending.empty()) {
+            int pos = pending.back();
+            pending.pop_back();
+            int i = pos / cols, j = pos % cols;
+            if (board[i][j].isRevealed || board[i][j].isFlagged) continue;
+            showSafeCell(i, j);
+            if (cellNumbers[pos] != 0) continue;
+
+            for (int x = qMax(0, i - 1); x <= qMin(rows - 1, i + 1); ++x) {
+                for (int y = qMax(0, j - 1); y <= qMin(cols - 1, j + 1); ++y) {
+                    if (!board[x][y].isRevealed) pending.push_back(x * cols + y);
+                }
             }
         }
+        return;
+    }
+
+    // 点到 0：按生成时预先标记好的空白区整片展开
+    int opening = openingIndex.openingOf[row * cols + col];
+    for (int k = openingIndex.offsets[opening]; k < openingIndex.offsets[opening + 1]; ++k) {
+        int pos = openingIndex.cells[k];
+        Cell& cell = board[pos / cols][pos % cols];
+        if (cell.isRevealed || cell.isFlagged) continue;
+        showSafeCell(pos / cols, pos % cols);
     }
 }
 
+void MainWindow::showSafeCell(int row, int col)
+{
+    board[row][col].isRevealed = true;
+    revealedCount++;
+    gameSaver->setRevealed(row * cols + col, true);
+    boardView->setCellState(row, col, BoardView::Revealed + cellNumbers[row * cols + col]);
+}
+
 void MainWindow::revealAllMines()
 {
+    // 还没开局（布局尚未生成）时没有地雷可显示
+    if (cellNumbers.empty()) return;
+
     for (int i = 0; i < rows; ++i) {
         for (int j = 0; j < cols; ++j) {
-            if (board[i][j].isMine) {
-                board[i][j].button->setText("*");
+            if (cellNumbers[i * cols + j] < 0) {
                 if (!board[i][j].isFlagged)
-                    board[i][j].button->setStyleSheet("background-color: #faa;");
+                    boardView->setCellState(i, j, BoardView::Mine);
             } else if (board[i][j].isFlagged) {
-                board[i][j].button->setText("X");
-                board[i][j].button->setStyleSheet("background-color: #fc6;");
+                boardView->setCellState(i, j, BoardView::WrongFlag);
             }
         }
     }
@@ -298,46 +326,50 @@ void MainWindow::revealAllMines()
 
 void MainWindow::checkGameStatus()
 {
-    bool allNonMinesRevealed = true;
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            if (!board[i][j].isMine && !board[i][j].isRevealed) {
-                allNonMinesRevealed = false;
-                break;
-            }
-        }
-        if (!allNonMinesRevealed) break;
-    }
+    // 已翻开的安全格数增量维护，不再每次点击扫描整个棋盘
+    bool allNonMinesRevealed = gameStarted && revealedCount == rows * cols - numMines;
 
     if (allNonMinesRevealed) {
+        // 3BV 要等后台的空白区分析完成，小棋盘上几乎不用等
+        if (openingsPending) onOpeningsReady(boardPrefetcher->waitForOpenings());
+
         for (int i = 0; i < rows; ++i) {
             for (int j = 0; j < cols; ++j) {
-                if (board[i][j].isMine) {
+                if (cellNumbers[i * cols + j] < 0) {
                     board[i][j].isFlagged = true;
-                    board[i][j].button->setText("F");
-                    board[i][j].button->setStyleSheet("background-color: #cfc; color: green;");
+                    boardView->setCellState(i, j, BoardView::SafeFlag);
                 }
             }
         }
+        flaggedCount = numMines;
         gameOver = true;
+        gameSaver->remove();
 
         if (isChallengeMode) {
             challengeTimer->stop();
 
-            timeRecorder->addRecord(challengeSecondsRemaining, getDifficultyString() + " (挑战模式)");
+            // 记录实际用时而不是剩余时间，统计和排名才能与普通模式同样解读
+            int usedSeconds = elapsedSeconds();
+            timeRecorder->addRecord(usedSeconds, getRecordDifficulty(), board3BV);
 
             QMessageBox::information(this, "挑战成功",
-                QString("恭喜你在挑战时间内完成！剩余时间: %1 秒\n\n难度: %2")
+                QString("恭喜你在挑战时间内完成！用时: %1 秒，剩余时间: %2 秒\n\n难度: %3  3BV: %4 (%5/秒)")
+                    .arg(usedSeconds)
                     .arg(challengeSecondsRemaining)
-                    .arg(getDifficultyString()));
+                    .arg(getDifficultyString())
+                    .arg(board3BV)
+                    .arg(double(board3BV) / qMax(1, usedSeconds), 0, 'f', 2));
         } else {
             timer->stop();
-            timeRecorder->addRecord(secondsElapsed, getDifficultyString());
+            secondsElapsed = elapsedSeconds();
+            timeRecorder->addRecord(secondsElapsed, getRecordDifficulty(), board3BV);
 
             QMessageBox::information(this, "游戏胜利",
-                QString("恭喜你赢了！用时: %1 秒\n\n难度: %2")
+                QString("恭喜你赢了！用时: %1 秒\n\n难度: %2  3BV: %3 (%4/秒)")
                     .arg(secondsElapsed)
-                    .arg(getDifficultyString()));
+                    .arg(getDifficultyString())
+                    .arg(board3BV)
+                    .arg(double(board3BV) / qMax(1, secondsElapsed), 0, 'f', 2));
         }
     }
 }
@@ -348,26 +380,36 @@ QString MainWindow::getDifficultyString() const
         case Beginner: return "初级";
         case Intermediate: return "中级";
         case Expert: return "高级";
+        case Custom: return QString("自定义 %1x%2/%3").arg(rows).arg(cols).arg(numMines);
         default: return "未知";
     }
 }
 
+QString MainWindow::getRecordDifficulty() const
+{
+    return isChallengeMode ? getDifficultyString() + " (挑战模式)" : getDifficultyString();
+}
+
+qint64 MainWindow::elapsedMs() const
+{
+    return elapsedBaseMs + gameClock.elapsed();
+}
+
+int MainWindow::elapsedSeconds() const
+{
+    return int(elapsedMs() / 1000);
+}
+
 void MainWindow::updateTimer()
 {
-    secondsElapsed++;
-    timeLabel->setText(QString("%1").arg(secondsElapsed, 3, 10, QChar('0')));
-    if (secondsElapsed >= 999) timer->stop();
+    // 用时按 gameClock 计算、不设上限，只有显示封顶 999
+    secondsElapsed = elapsedSeconds();
+    timeLabel->setText(QString("%1").arg(qMin(secondsElapsed, 999), 3, 10, QChar('0')));
 }
 
 void MainWindow::updateMineCount()
 {
-    int flagged = 0;
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0;j < cols; ++j) {
-            if (board[i][j].isFlagged) flagged++;
-        }
-    }
-    int remaining = numMines - flagged;
+    int remaining = numMines - flaggedCount;
     mineCountLabel->setText(QString("%1").arg(remaining, 3, 10, QChar('0')));
 }
 
@@ -377,60 +419,98 @@ void MainWindow::onButtonClicked(int position)
     int row = position / cols;
     int col = position % cols;
 
-    if (gameOver || board[row][col].isRevealed || board[row][col].isFlagged) return;
+    if (gameOver || waitingForBoard || board[row][col].isRevealed || board[row][col].isFlagged) return;
 
     if (!gameStarted) {
-        gameStarted = true;
         firstClickRow = row;
         firstClickCol = col;
 
-        if (isChallengeMode) {
-            challengeTimer->start(1000);
-        } else {
-            timer->start(1000);
+        // 直接取用后台预生成的布局，只在首击周围挪雷；
+        // 池子还空着（刚开局就点）才交给后台生成，完成后在 onBoardPrepared 里接着翻开
+        PreparedBoardPtr prepared = boardPrefetcher->take(row, col);
+        if (!prepared) {
+            waitingForBoard = true;
+            setCursor(Qt::BusyCursor);
+            boardPrefetcher->prepareFor(row, col);
+            return;
         }
-
-
-        placeMinesWithSafety();
-        calculateAdjacentMines();
+        startGame(prepared);
     }
 
     revealCell(row, col);
     checkGameStatus();
 }
-void MainWindow::placeMinesWithSafety()
+
+void MainWindow::onBoardPrepared(PreparedBoardPtr prepared)
 {
+    if (!waitingForBoard || prepared->rows != rows || prepared->cols != cols ||
+        prepared->numMines != numMines)
+        return;
+
+    waitingForBoard = false;
+    unsetCursor();
+    // 等待期间挑战时间可能已经用完
+    if (gameOver) return;
+    startGame(prepared);
+    revealCell(firstClickRow, firstClickCol);
+    checkGameStatus();
+}
 
-    int startRow = qMax(0, firstClickRow - 1);
-    int endRow = qMin(rows - 1, firstClickRow + 1);
-    int startCol = qMax(0, firstClickCol - 1);
-    int endCol = qMin(cols - 1, firstClickCol + 1);
+void MainWindow::startGame(const PreparedBoardPtr& prepared)
+{
+    gameStarted = true;
+    if (isChallengeMode) {
+        challengeTimer->start(1000);
+    } else {
+        timer->start(1000);
+    }
 
-    int minesPlaced = 0;
-    while (minesPlaced < numMines) {
-        int row = rand() % rows;
-        int col = rand() % cols;
+    // 数字已按首击修正好，这里只交换所有权；
+    // 移过雷时空白区和 3BV 由 onOpeningsReady 随后补上
+    cellNumbers.swap(prepared->numbers);
+    openingsPending = !prepared->openingsValid;
+    if (!openingsPending) {
+        std::swap(openingIndex, prepared->openings);
+        board3BV = prepared->bbbv;
+    }
+    boardSeed = prepared->seed;
 
-        if (row >= startRow && row <= endRow && col >= startCol && col <= endCol) {
-            continue;
-        }
-        if (!board[row][col].isMine) {
-            board[row][col].isMine = true;
-            minesPlaced++;
+    // 存档位图从这一局开始记录，首击前插的旗子也一并写入
+    gameSaver->reset(rows, cols, prepared->mineBits);
+    if (flaggedCount > 0) {
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                if (board[i][j].isFlagged) gameSaver->setFlagged(i * cols + j, true);
+            }
         }
     }
+    elapsedBaseMs = 0;
+    gameClock.start();
 }
+
+void MainWindow::onOpeningsReady(PreparedBoardPtr analyzed)
+{
+    // 只收本局的结果：重开后旧布局的分析直接丢弃
+    if (!openingsPending || analyzed->seed != boardSeed ||
+        analyzed->rows != rows || analyzed->cols != cols)
+        return;
+
+    openingsPending = false;
+    std::swap(openingIndex, analyzed->openings);
+    board3BV = analyzed->bbbv;
+}
+
 void MainWindow::onRightClick(int position)
 {
     int row = position / cols;
     int col = position % cols;
 
-    if (gameOver || board[row][col].isRevealed) return;
+    if (gameOver || waitingForBoard || board[row][col].isRevealed) return;
 
     board[row][col].isFlagged = !board[row][col].isFlagged;
-    board[row][col].button->setText(board[row][col].isFlagged ? "F" : "");
-    board[row][col].button->setStyleSheet(board[row][col].isFlagged ?
-        "background-color: #fcc;" : "border: 1px solid gray; background-color: #ccc;");
+    flaggedCount += board[row][col].isFlagged ? 1 : -1;
+    if (gameStarted) gameSaver->setFlagged(position, board[row][col].isFlagged);
+    boardView->setCellState(row, col, board[row][col].isFlagged ? BoardView::Flagged : BoardView::Hidden);
     updateMineCount();
     checkGameStatus();
 }
@@ -442,6 +522,15 @@ void MainWindow::onResetButtonClicked()
 
 void MainWindow::onDifficultyChanged(int index)
 {
+    // 重新选中同一难度不重开，只有“自定义”每次都弹出尺寸设置
+    if (index == currentDifficulty && index != Custom) return;
+    if (index == Custom && !askCustomSize()) {
+        // 取消自定义时回到原来的难度
+        difficultyCombo->blockSignals(true);
+        difficultyCombo->setCurrentIndex(currentDifficulty);
+        difficultyCombo->blockSignals(false);
+        return;
+    }
     setDifficulty(static_cast<Difficulty>(index));
     resetGame();
 }
@@ -457,23 +546,159 @@ void MainWindow::resetGame()
 
     gameOver = false;
     gameStarted = false;
+    waitingForBoard = false;
+    openingsPending = false;
+    unsetCursor();
     resetButton->setText("🙂");
     isChallengeMode = false;
 
     initBoard();
+    boardPrefetcher->prefetch(rows, cols, numMines);
+    gameSaver->remove();
 
     isFirstClick = true;
         gameStarted = false;
 }
+GameSaver::State MainWindow::currentSaveState() const
+{
+    GameSaver::State state;
+    state.rows = rows;
+    state.cols = cols;
+    state.numMines = numMines;
+    state.difficulty = currentDifficulty;
+    state.elapsedMs = elapsedMs();
+    state.challengeMode = isChallengeMode;
+    state.challengeSecondsRemaining = challengeSecondsRemaining;
+    state.seed = boardSeed;
+    state.clickRow = firstClickRow;
+    state.clickCol = firstClickCol;
+    return state;
+}
+
+void MainWindow::autosave()
+{
+    if (gameStarted && !gameOver) gameSaver->saveAsync(currentSaveState());
+}
+
+void MainWindow::closeEvent(QCloseEvent *event)
+{
+    if (gameStarted && !gameOver) gameSaver->save(currentSaveState());
+    QMainWindow::closeEvent(event);
+}
+
+bool MainWindow::resumeGame()
+{
+    GameSaver::State state;
+    if (!gameSaver->load(state) || state.difficulty < Beginner || state.difficulty > Custom) {
+        gameSaver->remove();
+        return false;
+    }
+
+    Difficulty previous = currentDifficulty;
+    Difficulty diff = static_cast<Difficulty>(state.difficulty);
+    if (diff == Custom) {
+        customRows = state.rows;
+        customCols = state.cols;
+        customMines = state.numMines;
+    }
+    setDifficulty(diff);
+    if (rows != state.rows || cols != state.cols || numMines != state.numMines) {
+        setDifficulty(previous);
+        gameSaver->remove();
+        return false;
+    }
+    difficultyCombo->blockSignals(true);
+    difficultyCombo->setCurrentIndex(diff);
+    difficultyCombo->blockSignals(false);
+
+    // 重置界面但保留已读入的存档位图，再按位图恢复棋盘
+    if (state.challengeMode) {
+        startChallenge(state.challengeSecondsRemaining);
+    } else {
+        resetGame();
+    }
+
+    PreparedBoard restored;
+    restored.rows = rows;
+    restored.cols = cols;
+    std::vector<char> mines(rows * cols);
+    for (int pos = 0; pos < rows * cols; ++pos) mines[pos] = gameSaver->isMine(pos);
+    BoardPrefetcher::analyze(mines, restored);
+    cellNumbers.swap(restored.numbers);
+    std::swap(openingIndex, restored.openings);
+    board3BV = restored.bbbv;
+
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < cols; ++j) {
+            int pos = i * cols + j;
+            if (gameSaver->isRevealed(pos)) {
+                showSafeCell(i, j);
+            } else if (gameSaver->isFlagged(pos)) {
+                board[i][j].isFlagged = true;
+                flaggedCount++;
+                boardView->setCellState(i, j, BoardView::Flagged);
+            }
+        }
+    }
+    updateMineCount();
+
+    gameStarted = true;
+    firstClickRow = state.clickRow;
+    firstClickCol = state.clickCol;
+    boardSeed = state.seed;
+    elapsedBaseMs = state.elapsedMs;
+    gameClock.start();
+    if (!isChallengeMode) {
+        secondsElapsed = int(state.elapsedMs / 1000);
+        timeLabel->setText(QString("%1").arg(qMin(secondsElapsed, 999), 3, 10, QChar('0')));
+        timer->start(1000);
+    }
+
+    // 上面的 resetGame 删掉了存档文件，恢复完立刻整体写回，
+    // 不必等下一次自动保存
+    gameSaver->save(currentSaveState());
+    return true;
+}
+
 RecordsDialog::RecordsDialog(const QList<TimeRecord>& records, QWidget* parent)
     : QDialog(parent)
 {
     setWindowTitle("游戏记录");
-    setFixedSize(200, 300);
+    setFixedSize(260, 300);
 
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
 
-    QScrollArea* scrollArea = new QScrollArea(this);
+    // 记录已按用时排序；3BV/s 排名只收有 3BV 的记录，
+    // 旧版本的挑战记录存的是剩余时间，也都没有 3BV，因此一并排除
+    QList<TimeRecord> byEfficiency;
+    for (const auto& record : records) {
+        if (record.bbbv > 0) byEfficiency.append(record);
+    }
+    std::stable_sort(byEfficiency.begin(), byEfficiency.end(),
+                     [](const TimeRecord& a, const TimeRecord& b) {
+                         return a.bbbvPerSecond() > b.bbbvPerSecond();
+                     });
+
+    QTabWidget* tabWidget = new QTabWidget(this);
+    tabWidget->addTab(createRecordList(records, tabWidget), "按用时");
+    tabWidget->addTab(createRecordList(byEfficiency, tabWidget), "按3BV/s");
+    mainLayout->addWidget(tabWidget);
+
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    QPushButton* clearButton = new QPushButton("清除所有记录", this);
+    connect(clearButton, &QPushButton::clicked, this, [this]() {
+        emit clearRecordsRequested();
+    });
+    buttonLayout->addWidget(clearButton);
+    mainLayout->addLayout(buttonLayout);
+
+    connect(this, &RecordsDialog::clearRecordsRequested,
+            [this]() { accept(); });
+}
+
+QScrollArea* RecordsDialog::createRecordList(const QList<TimeRecord>& records, QWidget* parent)
+{
+    QScrollArea* scrollArea = new QScrollArea(parent);
     scrollArea->setWidgetResizable(true);
     scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
@@ -498,6 +723,11 @@ RecordsDialog::RecordsDialog(const QList<TimeRecord>& records, QWidget* parent)
                 .arg(timeStr)
                 /*.arg(dateStr)*/
                 .arg(difficultyStr);
+            if (record.bbbv > 0) {
+                recordText += QString(" 3BV %1 (%2/秒)")
+                    .arg(record.bbbv)
+                    .arg(record.bbbvPerSecond(), 0, 'f', 2);
+            }
 
             QLabel* recordLabel = new QLabel(recordText, scrollWidget);
             recordLabel->setStyleSheet("border-bottom: 1px solid #eee; padding-bottom: 5px;");
@@ -507,18 +737,7 @@ RecordsDialog::RecordsDialog(const QList<TimeRecord>& records, QWidget* parent)
 
     scrollWidget->setLayout(scrollLayout);
     scrollArea->setWidget(scrollWidget);
-    mainLayout->addWidget(scrollArea);
-
-    QHBoxLayout* buttonLayout = new QHBoxLayout();
-    QPushButton* clearButton = new QPushButton("清除所有记录", this);
-    connect(clearButton, &QPushButton::clicked, this, [this]() {
-        emit clearRecordsRequested();
-    });
-    buttonLayout->addWidget(clearButton);
-    mainLayout->addLayout(buttonLayout);
-
-    connect(this, &RecordsDialog::clearRecordsRequested,
-            [this]() { accept(); });
+    return scrollArea;
 }
 
 void MainWindow::onRecordsButtonClicked()
@@ -534,6 +753,88 @@ void MainWindow::onRecordsButtonClicked()
 
     dialog->exec();
 }
+StatsDialog::StatsDialog(const QMap<QString, RecordStats>& stats, QWidget* parent)
+    : QDialog(parent)
+{
+    setWindowTitle("统计");
+    setFixedSize(320, 400);
+
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QScrollArea* scrollArea = new QScrollArea(this);
+    scrollArea->setWidgetResizable(true);
+    scrollArea->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    scrollArea->setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+
+    QWidget* scrollWidget = new QWidget(scrollArea);
+    QVBoxLayout* scrollLayout = new QVBoxLayout(scrollWidget);
+    scrollLayout->setSpacing(5);
+    scrollLayout->setMargin(10);
+
+    if (stats.isEmpty()) {
+        QLabel* emptyLabel = new QLabel("暂无统计", scrollWidget);
+        emptyLabel->setAlignment(Qt::AlignCenter);
+        emptyLabel->setStyleSheet("color: #999;");
+        scrollLayout->addWidget(emptyLabel);
+    }
+
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        const RecordStats& entry = it.value();
+
+        // 只有失败的局时没有用时可言，显示“—”而不是 0 秒
+        QString mean = "—", best = "—", median = "—", p90 = "—";
+        if (entry.count > 0) {
+            mean = QString("%1秒").arg(entry.mean(), 0, 'f', 1);
+            best = QString("%1秒").arg(entry.best);
+            median = QString("%1秒").arg(entry.median.value(), 0, 'f', 1);
+            p90 = QString("%1秒").arg(entry.p90.value(), 0, 'f', 1);
+        }
+
+        QString summary = QString("<b>%1</b><br>"
+                                  "胜 %2 / 负 %3<br>"
+                                  "平均 %4  最佳 %5<br>"
+                                  "中位数 %6  P90 %7<br>"
+                                  "当前连胜 %8  最长连胜 %9")
+            .arg(it.key())
+            .arg(entry.count)
+            .arg(entry.losses)
+            .arg(mean)
+            .arg(best)
+            .arg(median)
+            .arg(p90)
+            .arg(entry.currentStreak)
+            .arg(entry.bestStreak);
+
+        int maxBin = 0;
+        for (int value : entry.histogram) maxBin = qMax(maxBin, value);
+
+        QString histogramText;
+        for (int i = 0; i < entry.histogram.size(); ++i) {
+            if (entry.histogram[i] == 0) continue;
+            int barLength = qMax(1, entry.histogram[i] * 20 / maxBin);
+            histogramText += QString("<br>%1-%2秒 %3 %4")
+                .arg(i * RecordStats::HistogramBinSeconds)
+                .arg((i + 1) * RecordStats::HistogramBinSeconds - 1)
+                .arg(QString(barLength, QChar(0x2588)))
+                .arg(entry.histogram[i]);
+        }
+
+        QLabel* statsLabel = new QLabel(summary + histogramText, scrollWidget);
+        statsLabel->setStyleSheet("border-bottom: 1px solid #eee; padding-bottom: 5px;");
+        scrollLayout->addWidget(statsLabel);
+    }
+
+    scrollWidget->setLayout(scrollLayout);
+    scrollArea->setWidget(scrollWidget);
+    mainLayout->addWidget(scrollArea);
+}
+
+void MainWindow::onStatsButtonClicked()
+{
+    StatsDialog dialog(timeRecorder->getStats(), this);
+    dialog.exec();
+}
+
 void MainWindow::clearRecords()
 {
     int result = QMessageBox::question(
@@ -6,9 +6,13 @@
 #include <QLabel>
 #include <QTimer>
 #include <QComboBox>
-#include <QSignalMapper>
 #include <vector>
 #include "timerecorder.h"
+#include "boardmetrics.h"
+#include "boardprefetcher.h"
+#include "boardview.h"
+#include "gamesaver.h"
+#include <QElapsedTimer>
 #include <QScrollArea>
 #include <QVBoxLayout>
 #include <QDialog>
@@ -20,6 +24,14 @@ public:
     explicit RecordsDialog(const QList<TimeRecord>& records, QWidget* parent = nullptr);
 signals:
     void clearRecordsRequested();
+private:
+    static QScrollArea* createRecordList(const QList<TimeRecord>& records, QWidget* parent);
+};
+class StatsDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit StatsDialog(const QMap<QString, RecordStats>& stats, QWidget* parent = nullptr);
 };
 class MainWindow : public QMainWindow
 {
@@ -40,27 +52,44 @@ private slots:
     void startChallenge(int seconds);
     void clearRecords();
     void onRecordsButtonClicked();
+    void onStatsButtonClicked();
+    void autosave();
+    void onBoardPrepared(PreparedBoardPtr prepared);
+    void onOpeningsReady(PreparedBoardPtr analyzed);
+protected:
+    void closeEvent(QCloseEvent *event) override;
 private:
     struct Cell {
-        bool isMine;
         bool isRevealed;
         bool isFlagged;
-        int adjacentMines;
-        QPushButton* button;
     };
 
     enum Difficulty {
         Beginner,
         Intermediate,
-        Expert
+        Expert,
+        Custom
     };
 
     std::vector<std::vector<Cell> > board;
+    std::vector<signed char> cellNumbers;   // -1 为地雷，否则为周围地雷数
     QTimer* timer;
     int secondsElapsed;
     bool gameOver;
     bool gameStarted;
     int rows, cols, numMines;
+    int customRows, customCols, customMines;
+    int revealedCount, flaggedCount;
+    int board3BV;
+    OpeningIndex openingIndex;
+    BoardPrefetcher* boardPrefetcher;
+    quint32 boardSeed;
+    bool waitingForBoard;
+    bool openingsPending;   // 首击移过雷，空白区索引和 3BV 还在后台重建
+    GameSaver* gameSaver;
+    QTimer* autosaveTimer;
+    QElapsedTimer gameClock;
+    qint64 elapsedBaseMs;
     Difficulty currentDifficulty;
 
     int firstClickRow, firstClickCol;
@@ -71,8 +100,7 @@ private:
     QLabel *timeLabel;
     QPushButton *resetButton;
     QWidget *centralWidget;
-    QSignalMapper *leftClickMapper;
-    QSignalMapper *rightClickMapper;
+    BoardView *boardView;
 
 
     TimeRecorder* timeRecorder;
@@ -82,15 +110,21 @@ private:
         bool isChallengeMode;
     void setupUI();
     void setDifficulty(Difficulty diff);
+    bool askCustomSize();
     void initBoard();
-    void placeMinesWithSafety ();
-    void calculateAdjacentMines();
+    void startGame(const PreparedBoardPtr& prepared);
     void revealCell(int row, int col);
+    void showSafeCell(int row, int col);
     void revealAllMines();
     void checkGameStatus();
     void resetGame();
+    bool resumeGame();
+    GameSaver::State currentSaveState() const;
     void updateMineCount();
     QString getDifficultyString() const;
+    QString getRecordDifficulty() const;
+    qint64 elapsedMs() const;
+    int elapsedSeconds() const;
 
 };
 
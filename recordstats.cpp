@@ -0,0 +1,190 @@
+#include "recordstats.h"
+#include <QStringList>
+#include <algorithm>
+
+P2Quantile::P2Quantile(double p)
+    : p(p),
+      cnt(0)
+{
+    resetMarkers();
+}
+
+void P2Quantile::resetMarkers()
+{
+    for (int i = 0; i < 5; ++i) {
+        n[i] = i + 1;
+        q[i] = 0;
+    }
+    np[0] = 1;
+    np[1] = 1 + 2 * p;
+    np[2] = 1 + 4 * p;
+    np[3] = 3 + 2 * p;
+    np[4] = 5;
+    dn[0] = 0;
+    dn[1] = p / 2;
+    dn[2] = p;
+    dn[3] = (1 + p) / 2;
+    dn[4] = 1;
+}
+
+void P2Quantile::add(double x)
+{
+    // 前 5 个样本直接保存，凑满后排序作为初始标记点
+    if (cnt < 5) {
+        q[cnt++] = x;
+        if (cnt == 5) std::sort(q, q + 5);
+        return;
+    }
+    cnt++;
+
+    int k;
+    if (x < q[0]) {
+        q[0] = x;
+        k = 0;
+    } else if (x >= q[4]) {
+        q[4] = x;
+        k = 3;
+    } else {
+        k = 0;
+        while (k < 3 && x >= q[k + 1]) k++;
+    }
+
+    for (int i = k + 1; i < 5; ++i) n[i]++;
+    for (int i = 0; i < 5; ++i) np[i] += dn[i];
+
+    for (int i = 1; i <= 3; ++i) {
+        double d = np[i] - n[i];
+        if ((d >= 1 && n[i + 1] - n[i] > 1) || (d <= -1 && n[i - 1] - n[i] < -1)) {
+            int ds = d > 0 ? 1 : -1;
+            double candidate = parabolic(i, ds);
+            if (q[i - 1] < candidate && candidate < q[i + 1]) {
+                q[i] = candidate;
+            } else {
+                q[i] = linear(i, ds);
+            }
+            n[i] += ds;
+        }
+    }
+}
+
+double P2Quantile::parabolic(int i, int d) const
+{
+    return q[i] + double(d) / (n[i + 1] - n[i - 1]) *
+        ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+         (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double P2Quantile::linear(int i, int d) const
+{
+    return q[i] + d * (q[i + d] - q[i]) / (n[i + d] - n[i]);
+}
+
+double P2Quantile::value() const
+{
+    if (cnt == 0) return 0;
+    if (cnt >= 5) return q[2];
+
+    double sorted[5];
+    std::copy(q, q + cnt, sorted);
+    std::sort(sorted, sorted + cnt);
+    return sorted[qMin(cnt - 1, int(p * cnt))];
+}
+
+QString P2Quantile::serialize() const
+{
+    QStringList parts;
+    parts << QString::number(cnt);
+    for (int i = 0; i < 5; ++i) parts << QString::number(q[i], 'g', 17);
+    for (int i = 0; i < 5; ++i) parts << QString::number(n[i]);
+    for (int i = 0; i < 5; ++i) parts << QString::number(np[i], 'g', 17);
+    return parts.join(" ");
+}
+
+bool P2Quantile::deserialize(const QString& text)
+{
+    QStringList parts = text.split(" ");
+    if (parts.size() != 16) return false;
+
+    cnt = parts[0].toInt();
+    for (int i = 0; i < 5; ++i) q[i] = parts[1 + i].toDouble();
+    for (int i = 0; i < 5; ++i) n[i] = parts[6 + i].toInt();
+    for (int i = 0; i < 5; ++i) np[i] = parts[11 + i].toDouble();
+    return true;
+}
+
+RecordStats::RecordStats()
+    : count(0),
+      losses(0),
+      totalSeconds(0),
+      best(0),
+      currentStreak(0),
+      bestStreak(0),
+      median(0.5),
+      p90(0.9),
+      histogram(HistogramBins, 0)
+{
+}
+
+void RecordStats::addWin(int seconds)
+{
+    if (count == 0 || seconds < best) best = seconds;
+    count++;
+    totalSeconds += seconds;
+    median.add(seconds);
+    p90.add(seconds);
+
+    int bin = qBound(0, seconds / HistogramBinSeconds, HistogramBins - 1);
+    histogram[bin]++;
+
+    currentStreak++;
+    bestStreak = qMax(bestStreak, currentStreak);
+}
+
+void RecordStats::addLoss()
+{
+    losses++;
+    currentStreak = 0;
+}
+
+double RecordStats::mean() const
+{
+    return count > 0 ? double(totalSeconds) / count : 0;
+}
+
+QString RecordStats::serialize() const
+{
+    QStringList bins;
+    for (int value : histogram) bins << QString::number(value);
+
+    QStringList parts;
+    parts << QString::number(count)
+          << QString::number(losses)
+          << QString::number(totalSeconds)
+          << QString::number(best)
+          << QString::number(currentStreak)
+          << QString::number(bestStreak)
+          << median.serialize()
+          << p90.serialize()
+          << bins.join(";");
+    return parts.join(",");
+}
+
+bool RecordStats::deserialize(const QString& line)
+{
+    QStringList parts = line.split(",");
+    if (parts.size() != 9) return false;
+
+    QStringList bins = parts[8].split(";");
+    if (bins.size() != HistogramBins) return false;
+
+    if (!median.deserialize(parts[6]) || !p90.deserialize(parts[7])) return false;
+
+    count = parts[0].toInt();
+    losses = parts[1].toInt();
+    totalSeconds = parts[2].toLongLong();
+    best = parts[3].toInt();
+    currentStreak = parts[4].toInt();
+    bestStreak = parts[5].toInt();
+    for (int i = 0; i < HistogramBins; ++i) histogram[i] = bins[i].toInt();
+    return true;
+}
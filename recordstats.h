@@ -0,0 +1,57 @@
+#ifndef RECORDSTATS_H
+#define RECORDSTATS_H
+#include <QString>
+#include <QVector>
+
+// P² 流式分位数估计（Jain & Chlamtac），只保存 5 个标记点，O(1) 内存
+class P2Quantile
+{
+public:
+    explicit P2Quantile(double p = 0.5);
+
+    void add(double x);
+    double value() const;
+    int count() const { return cnt; }
+
+    QString serialize() const;
+    bool deserialize(const QString& text);
+private:
+    double p;
+    int cnt;
+    int n[5];
+    double np[5];
+    double dn[5];
+    double q[5];
+
+    void resetMarkers();
+    double parabolic(int i, int d) const;
+    double linear(int i, int d) const;
+};
+
+// 单个难度/模式的累计统计，随 addRecord 增量更新
+struct RecordStats
+{
+    static const int HistogramBinSeconds = 10;
+    static const int HistogramBins = 100;
+
+    int count;
+    int losses;
+    qint64 totalSeconds;
+    int best;
+    int currentStreak;
+    int bestStreak;
+    P2Quantile median;
+    P2Quantile p90;
+    QVector<int> histogram;
+
+    RecordStats();
+
+    void addWin(int seconds);
+    void addLoss();
+    double mean() const;
+
+    QString serialize() const;
+    bool deserialize(const QString& line);
+};
+
+#endif // RECORDSTATS_H
@@ -6,7 +6,7 @@
 
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 TARGET = saolei
 TEMPLATE = app
@@ -14,9 +14,19 @@ TEMPLATE = app
 
 SOURCES += main.cpp\
         mainwindow.cpp \
-    timerecorder.cpp
+    timerecorder.cpp \
+    recordstats.cpp \
+    boardmetrics.cpp \
+    boardprefetcher.cpp \
+    boardview.cpp \
+    gamesaver.cpp
 
 HEADERS  += mainwindow.h \
-    timerecorder.h
+    timerecorder.h \
+    recordstats.h \
+    boardmetrics.h \
+    boardprefetcher.h \
+    boardview.h \
+    gamesaver.h
 
 FORMS    += mainwindow.ui
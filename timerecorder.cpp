@@ -2,23 +2,36 @@
 #include <QFile>
 #include <QTextStream>
 #include <QDebug>
+#include <algorithm>
 
 TimeRecorder::TimeRecorder(QObject *parent) : QObject(parent)
 {
     filePath = "minesweeper_records.txt";
+    statsFilePath = "minesweeper_stats.txt";
     loadRecords();
+    loadStats();
 }
 
-void TimeRecorder::addRecord(int seconds, const QString& difficulty)
+void TimeRecorder::addRecord(int seconds, const QString& difficulty, int bbbv)
 {
     TimeRecord record;
     record.seconds = seconds;
     record.date = QDateTime::currentDateTime();
     record.difficulty = difficulty;
+    record.bbbv = bbbv;
 
-    records.append(record);
-    std::sort(records.begin(), records.end());
-    saveRecords();
+    // 二分插入保持有序，文件只追加一行，统计增量更新
+    records.insert(std::upper_bound(records.begin(), records.end(), record), record);
+    appendRecord(record);
+
+    stats[difficulty].addWin(seconds);
+    saveStats();
+}
+
+void TimeRecorder::addLoss(const QString& difficulty)
+{
+    stats[difficulty].addLoss();
+    saveStats();
 }
 
 QList<TimeRecord> TimeRecorder::getSortedRecords() const
@@ -26,6 +39,11 @@ QList<TimeRecord> TimeRecorder::getSortedRecords() const
     return records;
 }
 
+QMap<QString, RecordStats> TimeRecorder::getStats() const
+{
+    return stats;
+}
+
 void TimeRecorder::loadRecords()
 {
     QFile file(filePath);
@@ -43,11 +61,91 @@ void TimeRecorder::loadRecords()
             record.seconds = parts[0].toInt();
             record.date = QDateTime::fromString(parts[1], Qt::ISODate);
             record.difficulty = parts[2];
+            record.bbbv = parts.size() >= 4 ? parts[3].toInt() : 0;
             records.append(record);
         }
     }
 
     file.close();
+    std::stable_sort(records.begin(), records.end());
+}
+
+void TimeRecorder::appendRecord(const TimeRecord& record) const
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        qDebug() << "无法写入文件:" << filePath;
+        return;
+    }
+
+    QTextStream out(&file);
+    out << record.seconds << ","
+        << record.date.toString(Qt::ISODate) << ","
+        << record.difficulty << ","
+        << record.bbbv << "\n";
+
+    file.close();
+}
+
+void TimeRecorder::loadStats()
+{
+    QFile file(statsFilePath);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        rebuildStats();
+        return;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QString line = in.readLine();
+        int split = line.indexOf(",");
+        if (split <= 0) continue;
+
+        RecordStats entry;
+        if (entry.deserialize(line.mid(split + 1))) {
+            stats.insert(line.left(split), entry);
+        }
+    }
+
+    file.close();
+}
+
+void TimeRecorder::saveStats() const
+{
+    QFile file(statsFilePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << "无法写入文件:" << statsFilePath;
+        return;
+    }
+
+    QTextStream out(&file);
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        out << it.key() << "," << it.value().serialize() << "\n";
+    }
+
+    file.close();
+}
+
+void TimeRecorder::rebuildStats()
+{
+    // 旧版本没有统计文件时，按记录日期顺序回放一遍。
+    // 旧的挑战记录存的是剩余时间（也没有 3BV），不计入用时统计
+    if (records.isEmpty()) return;
+
+    QList<TimeRecord> byDate = records;
+    std::stable_sort(byDate.begin(), byDate.end(),
+                     [](const TimeRecord& a, const TimeRecord& b) { return a.date < b.date; });
+    for (const auto& record : byDate) {
+        if (record.bbbv == 0 && record.difficulty.endsWith("(挑战模式)")) continue;
+        stats[record.difficulty].addWin(record.seconds);
+    }
+
+    // 记录文件里没有失败的局，回放出来的连胜并不可信，从 0 重新开始计
+    for (auto it = stats.begin(); it != stats.end(); ++it) {
+        it.value().currentStreak = 0;
+        it.value().bestStreak = 0;
+    }
+    saveStats();
 }
 
 void TimeRecorder::saveRecords() const
@@ -62,7 +160,8 @@ void TimeRecorder::saveRecords() const
     for (const auto& record : records) {
         out << record.seconds << ","
             << record.date.toString(Qt::ISODate) << ","
-            << record.difficulty << "\n";
+            << record.difficulty << ","
+            << record.bbbv << "\n";
     }
 
     file.close();
@@ -70,5 +169,7 @@ void TimeRecorder::saveRecords() const
 void TimeRecorder::clearRecords()
 {
     records.clear();
+    stats.clear();
     saveRecords();
+    saveStats();
 }
@@ -4,11 +4,18 @@
 #include <QList>
 #include <QString>
 #include <QDateTime>
+#include <QMap>
+#include "recordstats.h"
 
 struct TimeRecord {
     int seconds;
     QDateTime date;
     QString difficulty;
+    int bbbv;
+
+    double bbbvPerSecond() const {
+        return double(bbbv) / (seconds > 0 ? seconds : 1);
+    }
 
     bool operator<(const TimeRecord& other) const {
         return seconds < other.seconds;
@@ -21,14 +28,22 @@ class TimeRecorder : public QObject
 public:
     explicit TimeRecorder(QObject *parent = nullptr);
 
-    void addRecord(int seconds, const QString& difficulty);
+    void addRecord(int seconds, const QString& difficulty, int bbbv = 0);
+    void addLoss(const QString& difficulty);
     QList<TimeRecord> getSortedRecords() const;
+    QMap<QString, RecordStats> getStats() const;
     void saveRecords() const;
     void clearRecords();
 private:
     QList<TimeRecord> records;
+    QMap<QString, RecordStats> stats;
     QString filePath;
+    QString statsFilePath;
 
     void loadRecords();
+    void appendRecord(const TimeRecord& record) const;
+    void loadStats();
+    void saveStats() const;
+    void rebuildStats();
 };
 #endif // TIMERECORDER_H